@@ -0,0 +1,135 @@
+//barrierbench.c
+//Description: Microbenchmark of the barriers the simulation can use. For
+//             1 to maxThreads threads it times a number of rounds in which
+//             every thread only waits at the barrier, first with
+//             pthread_barrier_wait and then with the spin barrier, and
+//             prints the average time of one round.
+//             Usage: ./barrierbench maxThreads [rounds]
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <unistd.h>
+#include <sys/time.h>
+#include <pthread.h>
+#include "pthread_barrier.h"
+#include "spinbarrier.h"
+
+#define DEFAULT_ROUNDS 100000
+
+pthread_barrier_t benchBarrier; // Barrier timed when not spin
+
+spinBarrier benchSpinBarrier; // Barrier timed when spin
+
+typedef struct benchArg{
+	int rounds; // Number of rounds to wait
+	int spin; // 1 to wait at the spin barrier, 0 at the pthread one
+} benchArg;
+
+/**
+ * Waits at the barrier being timed once per round
+ * @param arguments: pointer to the benchArg of the run
+ * @return NULL
+ */
+void* waitRounds(void* arguments){
+	benchArg* arg = (benchArg*) arguments;
+	int i;
+
+	for(i = 0; i < arg->rounds; i++){
+		if(arg->spin){
+			spinBarrierWait(&benchSpinBarrier);
+		}
+		else{
+			pthread_barrier_wait(&benchBarrier);
+		}
+	}
+	return NULL;
+}
+
+/**
+ * Times a number of rounds of a barrier with a number of threads
+ * @param numThreads: the number of threads waiting
+ * @param rounds: the number of rounds
+ * @param spin: 1 for the spin barrier, 0 for pthread_barrier_wait
+ * @return: the average time of one round in nanoseconds
+ * @throws exit(1) if the threads can not be created
+ */
+double timeBarrier(int numThreads, int rounds, int spin){
+	benchArg arg;
+	pthread_t* threadID;
+	struct timeval start_time, end_time;
+	int i;
+
+	arg.rounds = rounds;
+	arg.spin = spin;
+	if(spin){
+		initializeSpinBarrier(&benchSpinBarrier,numThreads,
+			numThreads <= sysconf(_SC_NPROCESSORS_ONLN) ? SPIN_LIMIT : 0);
+	}
+	else{
+		pthread_barrier_init(&benchBarrier,NULL,numThreads);
+	}
+	threadID = (pthread_t*) malloc(numThreads * sizeof(pthread_t));
+	if(threadID == NULL){
+		printf("%s", "error allocating threads");
+		exit(1);
+	}
+
+	gettimeofday(&start_time, 0);
+	for(i = 0; i < numThreads; i++){
+		if(pthread_create(&threadID[i],NULL,waitRounds,&arg) != 0){
+			printf("%s", "error creating threads");
+			exit(1);
+		}
+	}
+	for(i = 0; i < numThreads; i++){
+		pthread_join(threadID[i],NULL);
+	}
+	gettimeofday(&end_time, 0);
+
+	if(!spin){
+		pthread_barrier_destroy(&benchBarrier);
+	}
+	free(threadID);
+	return ((end_time.tv_sec - start_time.tv_sec) * 1000000.0 +
+		(end_time.tv_usec - start_time.tv_usec)) * 1000.0 / rounds;
+}
+
+/**
+ * Main. Prints the time per round of both barriers for each thread count.
+ * @param argc: amount of arguments in argv
+ * @param argv: array of command line arguments
+ * @return 0
+ * @throws exit(1) if the arguments are invalid
+ */
+int main(int argc, char* argv[]){
+	int maxThreads;
+	int rounds = DEFAULT_ROUNDS;
+	int i;
+	double pthreadTime;
+	double spinTime;
+
+	if(argc < 2){
+		printf("%s", "Not enough command line arguments");
+		exit(1);
+	}
+	maxThreads = atoi(argv[1]);
+	if(argc > 2){
+		rounds = atoi(argv[2]);
+	}
+	if(maxThreads <= 0 || rounds <= 0){
+		printf("%s", "threads and rounds must be greater than 0");
+		exit(1);
+	}
+
+	printf("%d rounds, %ld cores\n", rounds,
+		sysconf(_SC_NPROCESSORS_ONLN));
+	printf("Threads  pthread (ns)  spin (ns)  speedup\n");
+	for(i = 1; i <= maxThreads; i++){
+		pthreadTime = timeBarrier(i,rounds,0);
+		spinTime = timeBarrier(i,rounds,1);
+		printf("%7d  %12.1f  %9.1f  %6.2fx\n", i, pthreadTime, spinTime,
+			pthreadTime / spinTime);
+		fflush(stdout);
+	}
+	return 0;
+}
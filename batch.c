@@ -0,0 +1,342 @@
+//batch.c
+//Description: Batch mode. Runs every board listed in a manifest file in
+//             one process and prints one result line per board, in the
+//             order of the manifest, followed by the boards and cell
+//             updates per second of the whole batch. Small boards are
+//             handed out one at a time to numberOfThreads workers that each
+//             run a single threaded simulator, so the cores are kept busy
+//             without any barrier. Boards of at least --big cells are worth
+//             splitting and are run after them, one at a time, by a
+//             simulator using every thread. The simulators are created once
+//             and reused for every board.
+//             The manifest has one input file name per line, blank lines and
+//             lines starting with # are skipped.
+//             Every board is read with the same --format, --board and
+//             --iterations options.
+//             Usage: ./batch manifest numberOfThreads row/col/tile
+//             wrap/nowrap [options] [--big=N]
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/time.h>
+#include <pthread.h>
+#include "simulator.h"
+#include "boardfile.h"
+
+#define BIG_BOARD_CELLS 65536 // Default cells from which a board is split
+#define MANIFEST_LINE 4096 // Longest file name of the manifest
+
+typedef struct batchBoard{
+	char* fileName; // Input file of the board
+	int rows; // Number of rows in the grid
+	int cols; // Number of columns in the grid
+	int iterations; // Number of iterations run
+	int big; // 1 if the board is run by every thread
+	boardFile contents; // File read while marking it big, kept to run it
+	long long liveCount; // Live cells in the final board
+	long long totalLiveCount; // Live cells summed over every generation
+	double seconds; // Time spent simulating the board
+	const char* error; // Why the board could not be run, NULL if it was
+} batchBoard;
+
+typedef struct batchArg{
+	batchBoard* boards; // Every board of the manifest
+	int numBoards; // Number of boards
+	int next; // Next board to hand out, taken atomically
+	long long bigCells; // Cells from which a board is left for later
+	simOptions opts; // Options of the single threaded simulators
+	fileOptions fopts; // Format, board size and iterations of the files
+} batchArg;
+
+/**
+ * Returns the time between two points in seconds
+ * @param start_time: the earlier time
+ * @param end_time: the later time
+ * @return: the seconds elapsed
+ */
+double elapsed(struct timeval* start_time, struct timeval* end_time){
+	return (end_time->tv_sec - start_time->tv_sec) +
+		(end_time->tv_usec - start_time->tv_usec) / 1000000.0;
+}
+
+/**
+ * Reads the input file names of the manifest
+ * @param manifestName: the name of the manifest file
+ * @param numBoards: set to the number of boards
+ * @return: the boards, with only their file names set
+ * @throws exit(1) if the manifest can not be read
+ */
+batchBoard* readManifest(char* manifestName, int* numBoards){
+	FILE* manifest;
+	char line[MANIFEST_LINE];
+	int capacity = 64;
+	size_t length;
+	batchBoard* boards;
+
+	manifest = fopen(manifestName, "r");
+	if(manifest == NULL){
+		printf("%s", "Error opening manifest.");
+		exit(1);
+	}
+	boards = (batchBoard*) malloc(capacity * sizeof(batchBoard));
+	if(boards == NULL){
+		printf("%s", "error allocating boards");
+		exit(1);
+	}
+	*numBoards = 0;
+	while(fgets(line, sizeof(line), manifest) != NULL){
+		length = strlen(line);
+		while(length > 0 && (line[length-1] == '\n' ||
+			line[length-1] == '\r' || line[length-1] == ' ' ||
+			line[length-1] == '\t')){
+			line[--length] = '\0';
+		}
+		if(length == 0 || line[0] == '#'){
+			continue;
+		}
+		if(*numBoards == capacity){
+			capacity *= 2;
+			boards = (batchBoard*) realloc(boards,
+				capacity * sizeof(batchBoard));
+			if(boards == NULL){
+				printf("%s", "error allocating boards");
+				exit(1);
+			}
+		}
+		memset(&boards[*numBoards], 0, sizeof(batchBoard));
+		boards[*numBoards].fileName = strdup(line);
+		if(boards[*numBoards].fileName == NULL){
+			printf("%s", "error allocating boards");
+			exit(1);
+		}
+		(*numBoards)++;
+	}
+	fclose(manifest);
+	return boards;
+}
+
+/**
+ * Reads a board's file and runs it on a simulator. A board of at least
+ * bigCells cells is only marked big and keeps the file's contents, which are
+ * run when it is passed again.
+ * @param sim: the simulator to run the board on
+ * @param board: the board, gets its size and results or its error
+ * @param arg: the batch, for the file options and the wrap argument
+ * @param bigCells: cells from which the board is only marked big, 0 to run
+ *                  any board
+ * @param parseThreads: the most threads to parse the file with
+ * @return nothing
+ */
+void runBoard(simulator* sim, batchBoard* board, const batchArg* arg,
+	long long bigCells, int parseThreads){
+	FILE* inFile;
+	boardFile* contents = &board->contents;
+	struct timeval start_time, end_time;
+
+	if(!board->big){
+		inFile = fopen(board->fileName, "r");
+		if(inFile == NULL){
+			board->error = "Error opening file.";
+			return;
+		}
+		board->error = readBoardFile(inFile,contents,&arg->fopts,
+			parseThreads);
+		fclose(inFile);
+		board->rows = contents->rows;
+		board->cols = contents->cols;
+		board->iterations = contents->iterations;
+		if(board->error == NULL && bigCells > 0 &&
+			(long long) contents->rows * contents->cols >= bigCells){
+			board->big = 1;
+			return;
+		}
+	}
+	if(board->error == NULL && contents->bits != NULL){
+		contents->bits->wrap = arg->opts.wrap;
+		if(resumeSimulator(sim,contents->bits) != 0){
+			board->error = simulatorError(sim);
+		}
+	}
+	else if(board->error == NULL && loadSimulator(sim,contents->rows,
+		contents->cols,contents->cells,contents->numCells) != 0){
+		board->error = simulatorError(sim);
+	}
+	freeBoardFile(contents);
+	if(board->error != NULL){
+		return;
+	}
+	gettimeofday(&start_time, 0);
+	stepSimulator(sim,board->iterations);
+	gettimeofday(&end_time, 0);
+	board->seconds = elapsed(&start_time,&end_time);
+	board->liveCount = simulatorLiveCount(sim);
+	board->totalLiveCount = simulatorTotalLiveCount(sim);
+}
+
+/**
+ * Driver function of a worker of the small boards. Takes boards until none
+ * are left and runs the small ones on its own single threaded simulator.
+ * @param arguments: pointer to the batchArg of the batch
+ * @return NULL
+ */
+void* runSmallBoards(void* arguments){
+	batchArg* arg = (batchArg*) arguments;
+	simulator* sim;
+	int board;
+
+	sim = createSimulator(&arg->opts);
+	while((board = __atomic_fetch_add(&arg->next, 1, __ATOMIC_RELAXED)) <
+		arg->numBoards){
+		runBoard(sim,&arg->boards[board],arg,arg->bigCells,1);
+	}
+	destroySimulator(sim);
+	return NULL;
+}
+
+/**
+ * Prints the result line of a board
+ * @param board: the board
+ * @return nothing
+ */
+void printBoard(batchBoard* board){
+	if(board->error != NULL){
+		printf("%s: %s\n", board->fileName, board->error);
+		return;
+	}
+	printf("%s: %d iterations of %dx%d, %lld live cells, %lld in total, "
+		"%0.6f secs%s\n", board->fileName, board->iterations, board->rows,
+		board->cols, board->liveCount, board->totalLiveCount,
+		board->seconds, board->big ? " (all threads)" : "");
+}
+
+/**
+ * Main. Runs the small boards on every thread at once, then the big ones
+ * with every thread each, and prints the results and throughput.
+ * @param argc: amount of arguments in argv
+ * @param argv: array of command line arguments
+ * @return 0
+ * @throws exit(1) if the arguments or the manifest are invalid
+ */
+int main(int argc, char* argv[]){
+	batchArg arg;
+	simOptions opts;
+	simulator* sim = NULL;
+	pthread_t* threadID;
+	struct timeval start_time, end_time;
+	const char* error;
+	int numWorkers;
+	int numBig = 0;
+	int numRun = 0;
+	int i;
+	double runTime;
+	long long cellUpdates = 0;
+
+	if(argc < 5){
+		printf("%s", "Not enough command line arguments");
+		exit(1);
+	}
+	if(strcmp(argv[3],"row") != 0 && strcmp(argv[3],"col") != 0 &&
+		strcmp(argv[3],"tile") != 0){
+		printf("%s", "invalid partition argument");
+		exit(1);
+	}
+	if(strcmp(argv[4],"wrap") != 0 && strcmp(argv[4],"nowrap") != 0){
+		printf("%s", "invalid wrap argument");
+		exit(1);
+	}
+	defaultSimOptions(&opts);
+	opts.numThreads = atoi(argv[2]);
+	opts.partition = strcmp(argv[3],"row") == 0 ? PARTITION_ROW :
+		strcmp(argv[3],"col") == 0 ? PARTITION_COL : PARTITION_TILE;
+	opts.wrap = strcmp(argv[4],"wrap") == 0;
+	arg.bigCells = BIG_BOARD_CELLS;
+	defaultFileOptions(&arg.fopts);
+	for(i = 5; i < argc; i++){
+		if(parseFileOption(&arg.fopts,argv[i],&error)){
+			if(error != NULL){
+				printf("%s", error);
+				exit(1);
+			}
+			continue;
+		}
+		if(strncmp(argv[i],"--big=",6) == 0){
+			if(argv[i][6] == '\0' ||
+				strspn(argv[i]+6,"0123456789") != strlen(argv[i]+6)){
+				printf("%s", "invalid big argument");
+				exit(1);
+			}
+			arg.bigCells = atoll(argv[i]+6);
+			continue;
+		}
+		error = parseSimOption(&opts,argv[i]);
+		if(error != NULL){
+			printf("%s", error);
+			exit(1);
+		}
+	}
+	error = checkSimOptions(&opts);
+	if(error != NULL){
+		printf("%s", error);
+		exit(1);
+	}
+	arg.opts = opts;
+	arg.opts.numThreads = 1;
+	//Hashlife does not split a board between threads
+	if(opts.engine == ENGINE_HASHLIFE || opts.numThreads == 1){
+		arg.bigCells = 0;
+	}
+	arg.boards = readManifest(argv[1],&arg.numBoards);
+	arg.next = 0;
+
+	gettimeofday(&start_time, 0); //get start time
+	numWorkers = opts.numThreads < arg.numBoards ? opts.numThreads :
+		arg.numBoards;
+	threadID = (pthread_t*) malloc((numWorkers + 1) * sizeof(pthread_t));
+	if(threadID == NULL){
+		printf("%s", "error allocating threads");
+		exit(1);
+	}
+	for(i = 0; i < numWorkers; i++){
+		if(pthread_create(&threadID[i],NULL,runSmallBoards,&arg) != 0){
+			printf("%s", "error creating threads");
+			exit(1);
+		}
+	}
+	for(i = 0; i < numWorkers; i++){
+		pthread_join(threadID[i],NULL);
+	}
+	for(i = 0; i < arg.numBoards; i++){
+		if(arg.boards[i].big){
+			if(sim == NULL){
+				sim = createSimulator(&opts);
+			}
+			runBoard(sim,&arg.boards[i],&arg,0,opts.numThreads);
+			numBig += arg.boards[i].error == NULL;
+		}
+	}
+	destroySimulator(sim);
+	gettimeofday(&end_time, 0); //get end time
+
+	for(i = 0; i < arg.numBoards; i++){
+		printBoard(&arg.boards[i]);
+		if(arg.boards[i].error == NULL){
+			numRun++;
+			cellUpdates += (long long) arg.boards[i].rows *
+				arg.boards[i].cols * arg.boards[i].iterations;
+		}
+	}
+	runTime = elapsed(&start_time,&end_time);
+	printf("\nTotal time for %d boards (%d on all threads) is %0.6f secs\n",
+		numRun,numBig,runTime);
+	printf("%0.1f boards/sec, %0.0f cell updates/sec\n\n",
+		runTime > 0 ? numRun / runTime : 0.0,
+		runTime > 0 ? cellUpdates / runTime : 0.0);
+
+	for(i = 0; i < arg.numBoards; i++){
+		free(arg.boards[i].fileName);
+	}
+	free(arg.boards);
+	free(threadID);
+	return 0;
+}
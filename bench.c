@@ -0,0 +1,548 @@
+//bench.c
+//Description: Benchmark suite of the simulator. For every board size and
+//             density it makes a random board from a seed, so the same
+//             arguments always time the same boards, and runs it with every
+//             thread count and partition asked for. Each run does warmup
+//             trials and then timed trials, every trial reloading the board
+//             and stepping it a number of generations in one stepSimulator
+//             call, so only the generations are timed and not the reading,
+//             thread creation or output. A trial's time is its mean time of
+//             one generation. Prints one line per run, as CSV or JSON, with
+//             the median, 95th percentile and fastest of the trials' times,
+//             the cell updates per second of the median and the live cells
+//             left, which must be the same for every thread count and
+//             partition of a board.
+//             Usage: ./bench [--sizes=RxC,...] [--densities=D,...]
+//             [--threads=N,...] [--partitions=row,col,tile]
+//             [--generations=N] [--warmup=N] [--trials=N] [--seed=N]
+//             [--wrap] [--report=csv/json] [options]
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <stdint.h>
+#include <time.h>
+#include <unistd.h>
+#include "simulator.h"
+#include "bitboard.h"
+#include "checkpoint.h"
+
+#define MAX_LIST 64 // Most values of a list argument
+#define DEFAULT_SIZES "512x512,2048x2048"
+#define DEFAULT_DENSITIES "0.3"
+#define DEFAULT_PARTITIONS "row,col"
+
+typedef struct benchOptions{
+	int rows[MAX_LIST]; // Rows of each board size
+	int cols[MAX_LIST]; // Columns of each board size
+	int numSizes; // Number of board sizes
+	double densities[MAX_LIST]; // Chance of each cell being alive
+	int numDensities; // Number of densities
+	int threads[MAX_LIST]; // Thread counts to run
+	int numThreads; // Number of thread counts
+	int partitions[MAX_LIST]; // PARTITION_ values to run
+	int numPartitions; // Number of partitions
+	int generations; // Generations stepped in one trial
+	int warmup; // Untimed trials before the timed ones
+	int trials; // Timed trials of each run
+	uint64_t seed; // Seed of the random boards
+	int json; // 1 for JSON, 0 for CSV
+} benchOptions;
+
+/**
+ * Returns the next number of a splitmix64 sequence. The boards are made with
+ * it rather than rand() so they are the same with every C library.
+ * @param state: the state of the sequence, advanced
+ * @return: the next 64 random bits
+ */
+static uint64_t nextRandom(uint64_t* state){
+	uint64_t z;
+
+	*state += 0x9e3779b97f4a7c15ULL;
+	z = *state;
+	z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+	z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+	return z ^ (z >> 31);
+}
+
+/**
+ * Makes a random board. The generator is seeded from the seed, size and
+ * density, so a board does not depend on the other boards of the run.
+ * @param rows: the number of rows
+ * @param cols: the number of columns
+ * @param density: the chance of each cell being alive
+ * @param seed: the seed
+ * @param wrap: 0 for nowrap 1 for wrap
+ * @return: the board as a checkpoint of generation 0
+ * @throws exit(1) if the board can not be allocated
+ */
+static checkpoint* randomBoard(int rows, int cols, double density,
+	uint64_t seed, int wrap){
+	checkpoint* board;
+	uint64_t state;
+	uint64_t limit;
+	int row, col;
+
+	board = initializeCheckpoint(rows,cols,wrap);
+	state = seed ^ ((uint64_t) rows << 32) ^ (uint64_t) cols ^
+		(uint64_t) (density * 1e9) << 16;
+	//a cell is alive when its 53 random bits are under density * 2^53
+	limit = (uint64_t) (density * 9007199254740992.0);
+	for(row = 0; row < rows; row++){
+		for(col = 0; col < cols; col++){
+			if((nextRandom(&state) >> 11) < limit){
+				board->bits[(size_t) row * board->words +
+					col / BITS_PER_WORD] |= 1ULL << (col % BITS_PER_WORD);
+				board->liveCount++;
+			}
+		}
+	}
+	return board;
+}
+
+/**
+ * Returns the time of a monotonic clock, which NTP adjustments do not move
+ * @return: the time in seconds
+ */
+static double now(void){
+	struct timespec time;
+
+	clock_gettime(CLOCK_MONOTONIC, &time);
+	return time.tv_sec + time.tv_nsec / 1000000000.0;
+}
+
+/**
+ * Compares two doubles for qsort
+ * @param a: pointer to the first double
+ * @param b: pointer to the second double
+ * @return: negative, 0 or positive as a is less, equal or greater
+ */
+static int compareTimes(const void* a, const void* b){
+	double x = *(const double*) a;
+	double y = *(const double*) b;
+
+	return (x > y) - (x < y);
+}
+
+/**
+ * Returns a percentile of sorted times, interpolated between the two times
+ * around it, so the median of an even number of times is the mean of the
+ * middle two
+ * @param times: the times, sorted
+ * @param numTimes: the number of times
+ * @param percent: the percentile, 0 to 100
+ * @return: the time at the percentile
+ */
+static double percentile(const double* times, int numTimes, int percent){
+	double pos = percent / 100.0 * (numTimes - 1);
+	int rank = (int) pos;
+
+	if(rank + 1 >= numTimes){
+		return times[numTimes - 1];
+	}
+	return times[rank] + (pos - rank) * (times[rank + 1] - times[rank]);
+}
+
+/**
+ * Reads a number argument above 0
+ * @param value: the text of the number
+ * @param error: the error printed if it is not a number above 0
+ * @return: the number
+ * @throws exit(1) if the number is invalid
+ */
+static int readCount(const char* value, const char* error){
+	if(value[0] == '\0' || strspn(value,"0123456789") != strlen(value) ||
+		atoi(value) <= 0){
+		printf("%s", error);
+		exit(1);
+	}
+	return atoi(value);
+}
+
+/**
+ * Splits a comma separated list argument into its values
+ * @param list: the list, changed in place
+ * @param values: set to the start of each value
+ * @param error: the error printed if the list is empty or too long
+ * @return: the number of values
+ * @throws exit(1) if the list is invalid
+ */
+static int splitList(char* list, char** values, const char* error){
+	int count = 0;
+	char* value;
+	char* save;
+
+	for(value = strtok_r(list, ",", &save); value != NULL;
+		value = strtok_r(NULL, ",", &save)){
+		if(count == MAX_LIST){
+			printf("%s", error);
+			exit(1);
+		}
+		values[count++] = value;
+	}
+	if(count == 0){
+		printf("%s", error);
+		exit(1);
+	}
+	return count;
+}
+
+/**
+ * Reads the board sizes of --sizes, each rows x columns
+ * @param bopts: gets the sizes
+ * @param list: the list, changed in place
+ * @return nothing
+ * @throws exit(1) if a size is invalid
+ */
+static void readSizes(benchOptions* bopts, char* list){
+	char* values[MAX_LIST];
+	char* cross;
+	int i;
+
+	bopts->numSizes = splitList(list,values,"invalid sizes argument");
+	for(i = 0; i < bopts->numSizes; i++){
+		cross = strchr(values[i],'x');
+		if(cross == NULL){
+			printf("%s", "invalid sizes argument");
+			exit(1);
+		}
+		*cross = '\0';
+		bopts->rows[i] = readCount(values[i],"invalid sizes argument");
+		bopts->cols[i] = readCount(cross + 1,"invalid sizes argument");
+	}
+}
+
+/**
+ * Reads the densities of --densities, each between 0 and 1
+ * @param bopts: gets the densities
+ * @param list: the list, changed in place
+ * @return nothing
+ * @throws exit(1) if a density is invalid
+ */
+static void readDensities(benchOptions* bopts, char* list){
+	char* values[MAX_LIST];
+	char* end;
+	int i;
+
+	bopts->numDensities = splitList(list,values,
+		"invalid densities argument");
+	for(i = 0; i < bopts->numDensities; i++){
+		bopts->densities[i] = strtod(values[i],&end);
+		if(end == values[i] || *end != '\0' || bopts->densities[i] < 0 ||
+			bopts->densities[i] > 1){
+			printf("%s", "invalid densities argument");
+			exit(1);
+		}
+	}
+}
+
+/**
+ * Reads the thread counts of --threads
+ * @param bopts: gets the thread counts
+ * @param list: the list, changed in place
+ * @return nothing
+ * @throws exit(1) if a thread count is invalid
+ */
+static void readThreads(benchOptions* bopts, char* list){
+	char* values[MAX_LIST];
+	int i;
+
+	bopts->numThreads = splitList(list,values,"invalid threads argument");
+	for(i = 0; i < bopts->numThreads; i++){
+		bopts->threads[i] = readCount(values[i],"invalid threads argument");
+	}
+}
+
+/**
+ * Reads the partitions of --partitions, each row, col or tile
+ * @param bopts: gets the partitions
+ * @param list: the list, changed in place
+ * @return nothing
+ * @throws exit(1) if a partition is invalid
+ */
+static void readPartitions(benchOptions* bopts, char* list){
+	char* values[MAX_LIST];
+	int i;
+
+	bopts->numPartitions = splitList(list,values,
+		"invalid partitions argument");
+	for(i = 0; i < bopts->numPartitions; i++){
+		if(strcmp(values[i],"row") == 0){
+			bopts->partitions[i] = PARTITION_ROW;
+		}
+		else if(strcmp(values[i],"col") == 0){
+			bopts->partitions[i] = PARTITION_COL;
+		}
+		else if(strcmp(values[i],"tile") == 0){
+			bopts->partitions[i] = PARTITION_TILE;
+		}
+		else{
+			printf("%s", "invalid partitions argument");
+			exit(1);
+		}
+	}
+}
+
+/**
+ * Reads a list argument from a copy, so defaults held in string literals can
+ * be read the same way as arguments
+ * @param bopts: gets the values
+ * @param list: the list
+ * @param read: the function reading the list
+ * @return nothing
+ * @throws exit(1) if the copy can not be allocated or the list is invalid
+ */
+static void readList(benchOptions* bopts, const char* list,
+	void (*read)(benchOptions*, char*)){
+	char* copy = strdup(list);
+
+	if(copy == NULL){
+		printf("%s", "error allocating arguments");
+		exit(1);
+	}
+	read(bopts,copy);
+	free(copy);
+}
+
+/**
+ * Fills in the thread counts used when --threads is not given: 1, then
+ * doubling up to the number of cores, then the number of cores
+ * @param bopts: gets the thread counts
+ * @return nothing
+ */
+static void defaultThreads(benchOptions* bopts){
+	long cores = sysconf(_SC_NPROCESSORS_ONLN);
+	int count;
+
+	bopts->numThreads = 0;
+	for(count = 1; count < cores && bopts->numThreads < MAX_LIST - 1;
+		count *= 2){
+		bopts->threads[bopts->numThreads++] = count;
+	}
+	bopts->threads[bopts->numThreads++] = cores > 1 ? (int) cores : 1;
+}
+
+/**
+ * Reads the arguments. Arguments that are not benchmark options are
+ * simulator options, the same as for main.
+ * @param argc: amount of arguments in argv
+ * @param argv: array of command line arguments
+ * @param bopts: gets the benchmark options
+ * @param opts: gets the simulator options, other than threads and partition
+ * @return nothing
+ * @throws exit(1) if an argument is invalid
+ */
+static void getOptions(int argc, char* argv[], benchOptions* bopts,
+	simOptions* opts){
+	const char* error;
+	int i;
+
+	memset(bopts, 0, sizeof(benchOptions));
+	readList(bopts,DEFAULT_SIZES,readSizes);
+	readList(bopts,DEFAULT_DENSITIES,readDensities);
+	readList(bopts,DEFAULT_PARTITIONS,readPartitions);
+	defaultThreads(bopts);
+	bopts->generations = 100;
+	bopts->warmup = 1;
+	bopts->trials = 5;
+	bopts->seed = 1;
+	defaultSimOptions(opts);
+	for(i = 1; i < argc; i++){
+		if(strncmp(argv[i],"--sizes=",8) == 0){
+			readSizes(bopts,argv[i]+8);
+		}
+		else if(strncmp(argv[i],"--densities=",12) == 0){
+			readDensities(bopts,argv[i]+12);
+		}
+		else if(strncmp(argv[i],"--threads=",10) == 0){
+			readThreads(bopts,argv[i]+10);
+		}
+		else if(strncmp(argv[i],"--partitions=",13) == 0){
+			readPartitions(bopts,argv[i]+13);
+		}
+		else if(strncmp(argv[i],"--generations=",14) == 0){
+			bopts->generations = readCount(argv[i]+14,
+				"invalid generations argument");
+		}
+		else if(strncmp(argv[i],"--warmup=",9) == 0){
+			if(argv[i][9] == '\0' ||
+				strspn(argv[i]+9,"0123456789") != strlen(argv[i]+9)){
+				printf("%s", "invalid warmup argument");
+				exit(1);
+			}
+			bopts->warmup = atoi(argv[i]+9);
+		}
+		else if(strncmp(argv[i],"--trials=",9) == 0){
+			bopts->trials = readCount(argv[i]+9,"invalid trials argument");
+		}
+		else if(strncmp(argv[i],"--seed=",7) == 0){
+			if(argv[i][7] == '\0' ||
+				strspn(argv[i]+7,"0123456789") != strlen(argv[i]+7)){
+				printf("%s", "invalid seed argument");
+				exit(1);
+			}
+			bopts->seed = strtoull(argv[i]+7,NULL,10);
+		}
+		else if(strcmp(argv[i],"--wrap") == 0){
+			opts->wrap = 1;
+		}
+		else if(strcmp(argv[i],"--report=csv") == 0){
+			bopts->json = 0;
+		}
+		else if(strcmp(argv[i],"--report=json") == 0){
+			bopts->json = 1;
+		}
+		else{
+			error = parseSimOption(opts,argv[i]);
+			if(error != NULL){
+				printf("%s", error);
+				exit(1);
+			}
+		}
+	}
+}
+
+/**
+ * Times one board with one set of simulator options
+ * @param sim: the simulator, with the options to time
+ * @param board: the board, loaded again before every trial
+ * @param bopts: the generations, warmup and trials
+ * @param times: gets each trial's mean seconds of one generation, sorted
+ * @return: the live cells after the last trial
+ * @throws exit(1) if the board can not be loaded
+ */
+static long long timeBoard(simulator* sim, const checkpoint* board,
+	const benchOptions* bopts, double* times){
+	double start;
+	int trial;
+
+	for(trial = -bopts->warmup; trial < bopts->trials; trial++){
+		if(resumeSimulator(sim,board) != 0){
+			printf("%s", simulatorError(sim));
+			exit(1);
+		}
+		start = now();
+		stepSimulator(sim,bopts->generations);
+		if(trial >= 0){
+			times[trial] = (now() - start) / bopts->generations;
+		}
+	}
+	qsort(times, bopts->trials, sizeof(double), compareTimes);
+	return simulatorLiveCount(sim);
+}
+
+/**
+ * Prints the result of one run
+ * @param bopts: the benchmark options
+ * @param board: the board of the run
+ * @param density: the density of the board
+ * @param opts: the simulator options of the run
+ * @param times: each trial's mean seconds of one generation, sorted
+ * @param liveCount: the live cells after the last trial
+ * @param first: 1 for the first result printed
+ * @return nothing
+ */
+static void printResult(const benchOptions* bopts, const checkpoint* board,
+	double density, const simOptions* opts, const double* times,
+	long long liveCount, int first){
+	static const char* partitionNames[] = {"row", "col", "tile"};
+	double median = percentile(times,bopts->trials,50);
+	double p95 = percentile(times,bopts->trials,95);
+	double updates = median > 0 ?
+		(double) board->rows * board->cols / median : 0.0;
+
+	if(bopts->json){
+		printf("%s  {\"rows\": %d, \"cols\": %d, \"density\": %g, "
+			"\"seed\": %llu, \"threads\": %d, \"partition\": \"%s\", "
+			"\"generations\": %d, \"trials\": %d, \"median_trial_us\": %.3f, "
+			"\"p95_trial_us\": %.3f, \"min_trial_us\": %.3f, "
+			"\"cell_updates_per_sec\": %.0f, \"live_cells\": %lld}",
+			first ? "" : ",\n", board->rows, board->cols, density,
+			(unsigned long long) bopts->seed, opts->numThreads,
+			partitionNames[opts->partition], bopts->generations,
+			bopts->trials, median * 1e6, p95 * 1e6, times[0] * 1e6,
+			updates, liveCount);
+	}
+	else{
+		printf("%d,%d,%g,%llu,%d,%s,%d,%d,%.3f,%.3f,%.3f,%.0f,%lld\n",
+			board->rows, board->cols, density,
+			(unsigned long long) bopts->seed, opts->numThreads,
+			partitionNames[opts->partition], bopts->generations,
+			bopts->trials, median * 1e6, p95 * 1e6, times[0] * 1e6,
+			updates, liveCount);
+	}
+	fflush(stdout);
+}
+
+/**
+ * Main. Times every board size and density with every thread count and
+ * partition and prints the results as they finish.
+ * @param argc: amount of arguments in argv
+ * @param argv: array of command line arguments
+ * @return 0
+ * @throws exit(1) if the arguments are invalid or a board can not be run
+ */
+int main(int argc, char* argv[]){
+	benchOptions bopts;
+	simOptions opts;
+	simulator* sim;
+	checkpoint* board;
+	const char* error;
+	double* times;
+	long long liveCount;
+	int size, density, thread, partition;
+	int first = 1;
+
+	getOptions(argc,argv,&bopts,&opts);
+	//check every combination before spending time on any of them
+	for(thread = 0; thread < bopts.numThreads; thread++){
+		for(partition = 0; partition < bopts.numPartitions; partition++){
+			opts.numThreads = bopts.threads[thread];
+			opts.partition = bopts.partitions[partition];
+			error = checkSimOptions(&opts);
+			if(error != NULL){
+				printf("%s", error);
+				exit(1);
+			}
+		}
+	}
+	times = (double*) malloc(bopts.trials * sizeof(double));
+	if(times == NULL){
+		printf("%s", "error allocating trials");
+		exit(1);
+	}
+
+	if(bopts.json){
+		printf("[\n");
+	}
+	else{
+		printf("rows,cols,density,seed,threads,partition,generations,"
+			"trials,median_trial_us,p95_trial_us,min_trial_us,"
+			"cell_updates_per_sec,live_cells\n");
+	}
+	for(size = 0; size < bopts.numSizes; size++){
+		for(density = 0; density < bopts.numDensities; density++){
+			board = randomBoard(bopts.rows[size],bopts.cols[size],
+				bopts.densities[density],bopts.seed,opts.wrap);
+			for(thread = 0; thread < bopts.numThreads; thread++){
+				for(partition = 0; partition < bopts.numPartitions;
+					partition++){
+					opts.numThreads = bopts.threads[thread];
+					opts.partition = bopts.partitions[partition];
+					sim = createSimulator(&opts);
+					liveCount = timeBoard(sim,board,&bopts,times);
+					destroySimulator(sim);
+					printResult(&bopts,board,bopts.densities[density],
+						&opts,times,liveCount,first);
+					first = 0;
+				}
+			}
+			freeCheckpoint(board);
+		}
+	}
+	if(bopts.json){
+		printf("\n]\n");
+	}
+	free(times);
+	return 0;
+}
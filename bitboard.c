@@ -0,0 +1,289 @@
+//bitboard.c
+//Description: Bit-packed Game of Life board and its word-parallel (SWAR)
+//             step kernel. Bit b of word w in a row holds the cell at column
+//             w*64+b. Bits past the last column are kept at 0 so they never
+//             count as live neighbors.
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include "bitboard.h"
+
+/**
+ * Returns a pointer to the first word of a row of the board. Row index
+ * board->rows is the extra row that is always dead.
+ * @param board: the bit board
+ * @param row: the row to look up
+ * @return: pointer to the words of the row
+ */
+static uint64_t* bitRow(const bitBoard* board, int row){
+	return board->bits + (size_t) row * board->words;
+}
+
+/**
+ * Dynamically allocates a bit board of size row x col
+ * @param row: the number of rows in the grid
+ * @param col: the number of columns in the grid
+ * @param clear: 1 to set every cell dead, 0 to leave the words unset
+ * @return: returns a pointer to the newly allocated bit board
+ * @throws exit(1) if the board can not be allocated
+ */
+static bitBoard* createBitBoard(int row, int col, int clear){
+	bitBoard* board;
+	size_t words;
+
+	board = (bitBoard*) malloc(sizeof(bitBoard));
+	if(board == NULL){
+		printf("%s", "error allocating board");
+		exit(1);
+	}
+	board->rows = row;
+	board->cols = col;
+	board->words = (col + BITS_PER_WORD - 1) / BITS_PER_WORD;
+	board->lastBit = (col - 1) % BITS_PER_WORD;
+	board->lastMask = ~0ULL >> (BITS_PER_WORD - 1 - board->lastBit);
+	//one extra dead row is used as the neighbor row past the edges (nowrap)
+	words = (size_t) (row + 1) * board->words;
+	board->bits = (uint64_t*) (clear ? calloc(words, sizeof(uint64_t)) :
+		malloc(words * sizeof(uint64_t)));
+	if(board->bits == NULL){
+		printf("%s", "error allocating board");
+		exit(1);
+	}
+	return board;
+}
+
+/**
+ * Dynamically allocates a bit board of size row x col with all cells dead
+ * @param row: the number of rows in the grid
+ * @param col: the number of columns in the grid
+ * @return: returns a pointer to the newly initialized bit board
+ * @throws exit(1) if the board can not be allocated
+ */
+bitBoard* initializeBitBoard(int row, int col){
+	return createBitBoard(row,col,1);
+}
+
+/**
+ * Dynamically allocates a bit board of size row x col without setting its
+ * cells, so each thread can clear the rows it calculates with clearBitRows
+ * and the pages of those rows are placed on that thread's NUMA node
+ * @param row: the number of rows in the grid
+ * @param col: the number of columns in the grid
+ * @return: returns a pointer to the newly allocated bit board
+ * @throws exit(1) if the board can not be allocated
+ */
+bitBoard* allocateBitBoard(int row, int col){
+	return createBitBoard(row,col,0);
+}
+
+/**
+ * Sets the rows begRow to endRow-1 of a bit board to 0 (dead)
+ * @param board: the bit board
+ * @param begRow: the first row
+ * @param endRow: one past the last row, rows+1 to include the extra row
+ * @return nothing
+ */
+void clearBitRows(bitBoard* board, int begRow, int endRow){
+	if(endRow > begRow){
+		memset(bitRow(board,begRow), 0,
+			(size_t) (endRow - begRow) * board->words * sizeof(uint64_t));
+	}
+}
+
+/**
+ * Frees the memory allocated for a bit board
+ * @param board: the bit board to free, may be NULL
+ * @return nothing
+ */
+void freeBitBoard(bitBoard* board){
+	if(board != NULL){
+		free(board->bits);
+		free(board);
+	}
+}
+
+/**
+ * Sets the cell at [row,col] to alive
+ * @param board: the bit board
+ * @param row: row of the cell
+ * @param col: column of the cell
+ * @return nothing
+ */
+void setBitCell(bitBoard* board, int row, int col){
+	bitRow(board,row)[col / BITS_PER_WORD] |= 1ULL << (col % BITS_PER_WORD);
+}
+
+/**
+ * Returns the state of the cell at [row,col]
+ * @param board: the bit board
+ * @param row: row of the cell
+ * @param col: column of the cell
+ * @return: 1 if the cell is alive, 0 if it is dead
+ */
+int getBitCell(const bitBoard* board, int row, int col){
+	return (bitRow(board,row)[col / BITS_PER_WORD] >>
+		(col % BITS_PER_WORD)) & 1;
+}
+
+/**
+ * Prints the contents of a bit board on screen in the same format as
+ * displayBoard
+ * @param board: the bit board to be printed on screen
+ * @return nothing
+ * @throws exit(1) if the row buffer can not be allocated
+ */
+void displayBitBoard(const bitBoard* board){
+	char* line;
+	int i;
+	int j;
+
+	line = (char*) malloc(board->cols + 1);
+	if(line == NULL){
+		printf("%s", "error allocating board");
+		exit(1);
+	}
+	//build each row in a buffer and print it with one call
+	for(i = 0; i < board->rows; i++){
+		for(j = 0; j < board->cols; j++){
+			line[j] = getBitCell(board,i,j) == 0 ? '-' : '@';
+		}
+		line[board->cols] = '\n';
+		fwrite(line, 1, board->cols + 1, stdout);
+	}
+	free(line);
+}
+
+/**
+ * Returns word w of a row shifted so bit b holds the cell west of column
+ * w*64+b (column - 1).
+ * @param board: the bit board
+ * @param row: the words of the row
+ * @param w: index of the word
+ * @param wrap: 0 for nowrap 1 for wrap
+ * @return: the west neighbors of the word
+ */
+static inline uint64_t westOf(const bitBoard* board, const uint64_t* row,
+	int w, int wrap){
+	uint64_t carry = 0;
+
+	if(w > 0){
+		carry = row[w-1] >> (BITS_PER_WORD - 1);
+	}
+	else if(wrap){
+		carry = (row[board->words-1] >> board->lastBit) & 1;
+	}
+	return (row[w] << 1) | carry;
+}
+
+/**
+ * Returns word w of a row shifted so bit b holds the cell east of column
+ * w*64+b (column + 1).
+ * @param board: the bit board
+ * @param row: the words of the row
+ * @param w: index of the word
+ * @param wrap: 0 for nowrap 1 for wrap
+ * @return: the east neighbors of the word
+ */
+static inline uint64_t eastOf(const bitBoard* board, const uint64_t* row,
+	int w, int wrap){
+	uint64_t carry = 0;
+
+	if(w < board->words-1){
+		carry = row[w+1] << (BITS_PER_WORD - 1);
+	}
+	else if(wrap){
+		carry = (row[0] & 1) << board->lastBit;
+	}
+	return (row[w] >> 1) | carry;
+}
+
+/**
+ * Computes the next state of 64 cells at once. Each argument holds one of
+ * the nine cells of the neighborhood for every bit position. The eight
+ * neighbors are summed with full adders into a ones digit and the count of
+ * the twos digits; a cell lives when the sum is 3, or 2 and it is alive.
+ * @param nw,n,ne: neighbors in the row above
+ * @param w,c,e: west neighbor, the cells themselves, east neighbor
+ * @param sw,s,se: neighbors in the row below
+ * @return: the next state of the 64 cells
+ */
+static inline uint64_t nextWord(uint64_t nw, uint64_t n, uint64_t ne,
+	uint64_t w, uint64_t c, uint64_t e, uint64_t sw, uint64_t s, uint64_t se){
+	uint64_t up0,up1,mid0,mid1,down0,down1,ones,carry,p,q,oneTwo;
+
+	//two bit sums of each row (up to 3, 2 and 3)
+	up0 = nw ^ n ^ ne;
+	up1 = (nw & n) | (ne & (nw ^ n));
+	mid0 = w ^ e;
+	mid1 = w & e;
+	down0 = sw ^ s ^ se;
+	down1 = (sw & s) | (se & (sw ^ s));
+	//ones digit of the total and its carry into the twos
+	ones = up0 ^ mid0 ^ down0;
+	carry = (up0 & mid0) | (down0 & (up0 ^ mid0));
+	//exactly one of the four twos is set, so the total is 2 or 3
+	p = up1 ^ mid1;
+	q = down1 ^ carry;
+	oneTwo = (p ^ q) & ~((up1 & mid1) | (down1 & carry) | (p & q));
+
+	return oneTwo & (ones | c);
+}
+
+/**
+ * Calculates the next iteration of the rows [begRow,endRow) restricted to
+ * the words [begWord,endWord) and stores it in nextBoard. Produces the same
+ * cells as calcNextIteration under both wrap and nowrap.
+ * @param currentBoard: the bit board for the current iteration
+ * @param nextBoard: the bit board for the next iteration
+ * @param begRow: The start row for the thread
+ * @param endRow: One past the end row for the thread
+ * @param begWord: The start word for the thread
+ * @param endWord: One past the end word for the thread
+ * @param wrap: 0 for nowrap 1 for wrap
+ * @return: the number of live cells in the calculated part of nextBoard
+ */
+int calcNextBitIteration(const bitBoard* currentBoard, bitBoard* nextBoard,
+	int begRow, int endRow, int begWord, int endWord, int wrap){
+	int i;
+	int w;
+	int rows = currentBoard->rows;
+	int liveCells = 0;
+	const uint64_t* up;
+	const uint64_t* mid;
+	const uint64_t* down;
+	uint64_t* out;
+	uint64_t next;
+
+	for(i = begRow; i < endRow; i++){
+		mid = bitRow(currentBoard,i);
+		//neighbor rows past the edge wrap or read the dead row
+		if(i > 0){
+			up = bitRow(currentBoard,i-1);
+		}
+		else{
+			up = bitRow(currentBoard,wrap ? rows-1 : rows);
+		}
+		if(i < rows-1){
+			down = bitRow(currentBoard,i+1);
+		}
+		else{
+			down = bitRow(currentBoard,wrap ? 0 : rows);
+		}
+		out = bitRow(nextBoard,i);
+		for(w = begWord; w < endWord; w++){
+			next = nextWord(westOf(currentBoard,up,w,wrap),up[w],
+				eastOf(currentBoard,up,w,wrap),
+				westOf(currentBoard,mid,w,wrap),mid[w],
+				eastOf(currentBoard,mid,w,wrap),
+				westOf(currentBoard,down,w,wrap),down[w],
+				eastOf(currentBoard,down,w,wrap));
+			if(w == currentBoard->words-1){
+				next &= currentBoard->lastMask;
+			}
+			out[w] = next;
+			liveCells += __builtin_popcountll(next);
+		}
+	}
+	return liveCells;
+}
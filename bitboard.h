@@ -0,0 +1,40 @@
+//bitboard.h
+//Description: Bit-packed Game of Life board. Every row of the grid is stored
+//             as 64 cells per uint64_t word, so a board takes 1/8 of the
+//             memory of a byte grid and the next iteration of a whole word is
+//             computed at once with bitwise full-adder logic.
+
+#ifndef BITBOARD_H
+#define BITBOARD_H
+
+#include <stdint.h>
+
+#define BITS_PER_WORD 64
+
+typedef struct bitBoard{
+	int rows; // Number of rows in the grid
+	int cols; // Number of columns in the grid
+	int words; // Number of words used by each row
+	int lastBit; // Bit of the last word holding the last column
+	uint64_t lastMask; // Valid bits of the last word of each row
+	uint64_t* bits; // rows+1 rows of words, the extra row is always dead
+} bitBoard;
+
+bitBoard* initializeBitBoard(int row, int col);
+
+bitBoard* allocateBitBoard(int row, int col);
+
+void clearBitRows(bitBoard* board, int begRow, int endRow);
+
+void freeBitBoard(bitBoard* board);
+
+void setBitCell(bitBoard* board, int row, int col);
+
+int getBitCell(const bitBoard* board, int row, int col);
+
+void displayBitBoard(const bitBoard* board);
+
+int calcNextBitIteration(const bitBoard* currentBoard, bitBoard* nextBoard,
+	int begRow, int endRow, int begWord, int endWord, int wrap);
+
+#endif /* BITBOARD_H */
@@ -0,0 +1,160 @@
+//board.c
+//Description: Allocation and halo upkeep of the contiguous board. Each
+//             padded row is laid out as BOARD_PAD-1 unused cells, the west
+//             halo cell, the cols cells of the row and the east halo cell,
+//             rounded up to a whole number of cache lines so column 0 of
+//             every row starts on a 64-byte boundary. One halo row sits above
+//             row 0 and one below the last row.
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include "board.h"
+
+/**
+ * Dynamically allocates a board of size row x col in one aligned block
+ * without setting its cells, so each thread can clear the rows it
+ * calculates with clearBoardRows and the pages of those rows are placed on
+ * that thread's NUMA node
+ * @param row: the number of rows in the grid
+ * @param col: the number of columns in the grid
+ * @return: returns a pointer to the newly allocated board
+ * @throws exit(1) if the board can not be allocated
+ */
+cellBoard* allocateBoard(int row, int col){
+	cellBoard* board;
+	size_t size;
+
+	board = (cellBoard*) malloc(sizeof(cellBoard));
+	if(board == NULL){
+		printf("%s", "error allocating board");
+		exit(1);
+	}
+	board->rows = row;
+	board->cols = col;
+	//pad, the row and its east halo cell, rounded up to whole cache lines
+	board->stride = (BOARD_PAD + col + 1 + BOARD_PAD - 1) / BOARD_PAD *
+		BOARD_PAD;
+	size = (size_t) (row + 2) * board->stride * sizeof(cell);
+	board->mem = (cell*) aligned_alloc(BOARD_ALIGN, size);
+	if(board->mem == NULL){
+		printf("%s", "error allocating board");
+		exit(1);
+	}
+	board->cells = board->mem + board->stride + BOARD_PAD;
+	return board;
+}
+
+/**
+ * Dynamically allocates a board of size row x col in one aligned block and
+ * sets all cells, halo included, to 0 (dead)
+ * @param row: the number of rows in the grid
+ * @param col: the number of columns in the grid
+ * @return: returns a pointer to the newly initialized board
+ * @throws exit(1) if the board can not be allocated
+ */
+cellBoard* initializeBoard(int row, int col){
+	cellBoard* board = allocateBoard(row,col);
+
+	clearBoardRows(board,-1,row+1);
+	return board;
+}
+
+/**
+ * Sets the padded rows begRow to endRow-1 of a board to 0 (dead), halo
+ * cells included
+ * @param board: the board
+ * @param begRow: the first row, -1 for the halo row above row 0
+ * @param endRow: one past the last row, rows+1 to include the halo row
+ *                below the last row
+ * @return nothing
+ */
+void clearBoardRows(cellBoard* board, int begRow, int endRow){
+	if(endRow > begRow){
+		memset(board->mem + (size_t) (begRow + 1) * board->stride, 0,
+			(size_t) (endRow - begRow) * board->stride * sizeof(cell));
+	}
+}
+
+/**
+ * Frees the memory allocated for a board
+ * @param board: the board to free, may be NULL
+ * @return nothing
+ */
+void freeBoard(cellBoard* board){
+	if(board != NULL){
+		free(board->mem);
+		free(board);
+	}
+}
+
+/**
+ * Copies the edges of the grid into the opposite halo cells so reading
+ * across an edge wraps around. Must be called after the board is written
+ * and before it is read when the simulation wraps.
+ * @param board: the board whose halo is refreshed
+ * @return nothing
+ */
+void refreshHalo(cellBoard* board){
+	int i;
+
+	for(i = 0; i < board->rows; i++){
+		CELL(board,i,-1) = CELL(board,i,board->cols-1);
+		CELL(board,i,board->cols) = CELL(board,i,0);
+	}
+	//whole rows, so the corners come with them
+	memcpy(ROW(board,-1) - 1, ROW(board,board->rows-1) - 1,
+		(board->cols + 2) * sizeof(cell));
+	memcpy(ROW(board,board->rows) - 1, ROW(board,0) - 1,
+		(board->cols + 2) * sizeof(cell));
+}
+
+/**
+ * Copies the cells of a region that lie on an edge of the grid into the
+ * opposite halo cells. Threads that each refresh the region they calculated
+ * refresh the whole halo between them, so no thread has to refresh it
+ * alone after the others are done.
+ * @param board: the board whose halo is refreshed
+ * @param begRow: The start row of the region
+ * @param begCol: The start col of the region
+ * @param endCol: One past the end col of the region
+ * @param endRow: One past the end row of the region
+ * @return nothing
+ */
+void refreshHaloRegion(cellBoard* board, int begRow, int begCol, int endCol,
+	int endRow){
+	int i;
+
+	if(begRow >= endRow || begCol >= endCol){
+		return;
+	}
+	for(i = begRow; i < endRow; i++){
+		if(begCol == 0){
+			CELL(board,i,board->cols) = CELL(board,i,0);
+		}
+		if(endCol == board->cols){
+			CELL(board,i,-1) = CELL(board,i,board->cols-1);
+		}
+	}
+	//each corner is refreshed with the region holding the cell it copies
+	if(begRow == 0){
+		memcpy(ROW(board,board->rows) + begCol, ROW(board,0) + begCol,
+			(endCol - begCol) * sizeof(cell));
+		if(begCol == 0){
+			CELL(board,board->rows,board->cols) = CELL(board,0,0);
+		}
+		if(endCol == board->cols){
+			CELL(board,board->rows,-1) = CELL(board,0,board->cols-1);
+		}
+	}
+	if(endRow == board->rows){
+		memcpy(ROW(board,-1) + begCol, ROW(board,board->rows-1) + begCol,
+			(endCol - begCol) * sizeof(cell));
+		if(begCol == 0){
+			CELL(board,-1,board->cols) = CELL(board,board->rows-1,0);
+		}
+		if(endCol == board->cols){
+			CELL(board,-1,-1) = CELL(board,board->rows-1,board->cols-1);
+		}
+	}
+}
@@ -0,0 +1,48 @@
+//board.h
+//Description: Game of Life board stored as one contiguous, 64-byte aligned
+//             allocation with a one cell ghost border (halo) around the grid.
+//             The halo is always dead for nowrap and holds a copy of the
+//             opposite edge for wrap, so neighbors can be read without bounds
+//             or wrap checks. A cell is one byte, 0 dead or 1 alive, so a
+//             board takes a quarter of the memory and bandwidth of an int
+//             grid and a vector holds four times as many cells.
+
+#ifndef BOARD_H
+#define BOARD_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define BOARD_ALIGN 64 // Bytes, alignment of the allocation and of each row
+#define BOARD_PAD (BOARD_ALIGN / (int) sizeof(cell)) // cells before column 0
+
+typedef uint8_t cell; // One cell of the grid, 0 for dead 1 for alive
+
+typedef struct cellBoard{
+	int rows; // Number of rows in the grid
+	int cols; // Number of columns in the grid
+	int stride; // Number of cells from one row to the next
+	cell* cells; // Cell [0,0], row -1 and column -1 are the halo
+	cell* mem; // Start of the allocation
+} cellBoard;
+
+//Cell [i,j] of board b, i and j may be -1 or rows/cols to reach the halo
+#define CELL(b,i,j) ((b)->cells[(ptrdiff_t) (i) * (b)->stride + (j)])
+
+//Pointer to column 0 of row i of board b
+#define ROW(b,i) ((b)->cells + (ptrdiff_t) (i) * (b)->stride)
+
+cellBoard* allocateBoard(int row, int col);
+
+cellBoard* initializeBoard(int row, int col);
+
+void clearBoardRows(cellBoard* board, int begRow, int endRow);
+
+void freeBoard(cellBoard* board);
+
+void refreshHalo(cellBoard* board);
+
+void refreshHaloRegion(cellBoard* board, int begRow, int begCol, int endCol,
+	int endRow);
+
+#endif /* BOARD_H */
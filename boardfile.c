@@ -0,0 +1,974 @@
+//boardfile.c
+//Description: Reader of the input file. The file is mapped into memory (or
+//             read whole if it can not be, like a pipe) and its integers are
+//             parsed by hand, which is many times faster than fscanf. Big
+//             files are split into chunks at whitespace and the chunks are
+//             parsed by several threads at once, each into its own array,
+//             then the arrays are joined and every cell is checked to be on
+//             the board. Patterns are decoded straight into a bit-packed
+//             board, runs of live cells a word at a time, without a list of
+//             cells in between. Errors are returned as messages instead of
+//             ending the program, so a caller reading many files can report
+//             a bad one and go on with the rest.
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <limits.h>
+#include <pthread.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "bitboard.h"
+#include "boardfile.h"
+
+#define PARSE_CHUNK (1 << 20) // Fewest bytes of the file per parsing thread
+#define RLE_LINE 70 // Longest line of the body of a written RLE file
+
+typedef struct parseChunk{
+	const char* beg; // First byte of the chunk
+	const char* end; // One past the last byte of the chunk
+	int* values; // Integers parsed, in the order of the file
+	size_t count; // Number of integers parsed
+	size_t capacity; // Number of integers values can hold
+	const char* error; // Why the chunk could not be parsed, NULL if it was
+} parseChunk;
+
+/**
+ * Checks if a character is whitespace, the separators fscanf skips
+ * @param c: the character
+ * @return: 1 if it is whitespace, 0 otherwise
+ */
+static int isSpace(char c){
+	return c == ' ' || c == '\n' || c == '\t' || c == '\r' || c == '\v' ||
+		c == '\f';
+}
+
+/**
+ * Moves a position to the start of the next line
+ * @param pos: the position
+ * @param end: one past the last byte of the text
+ * @return: the first byte after the next newline, or end
+ */
+static const char* nextLine(const char* pos, const char* end){
+	while(pos < end && *pos != '\n'){
+		pos++;
+	}
+	return pos < end ? pos + 1 : end;
+}
+
+/**
+ * Skips the lines starting with a character, and the whitespace before them
+ * @param pos: the position to start at
+ * @param end: one past the last byte of the text
+ * @param mark: the first character of the lines to skip
+ * @return: the first byte that is not whitespace or in a skipped line
+ */
+static const char* skipLines(const char* pos, const char* end, char mark){
+	while(1){
+		while(pos < end && isSpace(*pos)){
+			pos++;
+		}
+		if(pos == end || *pos != mark){
+			return pos;
+		}
+		pos = nextLine(pos,end);
+	}
+}
+
+/**
+ * Parses the next integer of the text, skipping the whitespace before it
+ * @param pos: the position to start at, moved past the integer
+ * @param end: one past the last byte of the text
+ * @param value: set to the integer
+ * @return: 1 if an integer was parsed, 0 if only whitespace was left, -1 if
+ *          the text does not hold an integer there or it is too large
+ */
+static int parseInt(const char** pos, const char* end, int* value){
+	const char* p = *pos;
+	long long number = 0;
+	int negative = 0;
+	int digits = 0;
+
+	while(p < end && isSpace(*p)){
+		p++;
+	}
+	if(p == end){
+		*pos = p;
+		return 0;
+	}
+	if(*p == '-' || *p == '+'){
+		negative = *p == '-';
+		p++;
+	}
+	while(p < end && *p >= '0' && *p <= '9'){
+		number = number * 10 + (*p - '0');
+		if(number > (long long) INT_MAX + 1){
+			return -1;
+		}
+		digits++;
+		p++;
+	}
+	if(digits == 0 || (!negative && number > INT_MAX)){
+		return -1;
+	}
+	*value = negative ? (int) -number : (int) number;
+	*pos = p;
+	return 1;
+}
+
+/**
+ * Parses every integer of a chunk into the chunk's array
+ * @param arguments: pointer to the chunk
+ * @return NULL
+ * @throws exit(1) if the array can not be allocated
+ */
+static void* parseChunkValues(void* arguments){
+	parseChunk* chunk = (parseChunk*) arguments;
+	const char* pos = chunk->beg;
+	int value;
+	int found;
+
+	chunk->count = 0;
+	chunk->capacity = (chunk->end - chunk->beg) / 8 + 16;
+	chunk->values = (int*) malloc(chunk->capacity * sizeof(int));
+	if(chunk->values == NULL){
+		printf("%s", "error allocating cells");
+		exit(1);
+	}
+	while((found = parseInt(&pos,chunk->end,&value)) == 1){
+		if(chunk->count == chunk->capacity){
+			chunk->capacity *= 2;
+			chunk->values = (int*) realloc(chunk->values,
+				chunk->capacity * sizeof(int));
+			if(chunk->values == NULL){
+				printf("%s", "error allocating cells");
+				exit(1);
+			}
+		}
+		chunk->values[chunk->count++] = value;
+	}
+	chunk->error = found < 0 ? "error reading file" : NULL;
+	return NULL;
+}
+
+/**
+ * Maps a whole file into memory, or reads it into a buffer if it can not be
+ * mapped
+ * @param inFile: the file, read from its start
+ * @param size: set to the number of bytes
+ * @param mapped: set to 1 if the data was mapped, 0 if it was read
+ * @return: the data, NULL if the file is empty
+ * @throws exit(1) if the buffer can not be allocated
+ */
+static char* loadFileData(FILE* inFile, size_t* size, int* mapped){
+	struct stat info;
+	char* data;
+	size_t capacity = 1 << 16;
+	size_t got;
+
+	*size = 0;
+	*mapped = 0;
+	if(fstat(fileno(inFile), &info) == 0 && S_ISREG(info.st_mode)){
+		if(info.st_size == 0){
+			return NULL;
+		}
+		data = (char*) mmap(NULL, info.st_size, PROT_READ, MAP_PRIVATE,
+			fileno(inFile), 0);
+		if(data != MAP_FAILED){
+			madvise(data, info.st_size, MADV_SEQUENTIAL);
+			*size = info.st_size;
+			*mapped = 1;
+			return data;
+		}
+	}
+	data = (char*) malloc(capacity);
+	if(data == NULL){
+		printf("%s", "error allocating file buffer");
+		exit(1);
+	}
+	while((got = fread(data + *size, 1, capacity - *size, inFile)) > 0){
+		*size += got;
+		if(*size == capacity){
+			capacity *= 2;
+			data = (char*) realloc(data, capacity);
+			if(data == NULL){
+				printf("%s", "error allocating file buffer");
+				exit(1);
+			}
+		}
+	}
+	return data;
+}
+
+/**
+ * Gets the size of the grid and the number of iterations from the file
+ * @param board: gets the rows, columns and iterations
+ * @param pos: the start of the file, moved past the header
+ * @param end: one past the last byte of the file
+ * @returns: NULL on success, the error otherwise
+ */
+static const char* getSizeIterations(boardFile* board, const char** pos,
+	const char* end){
+	//get first 3 lines from file (row, col, iterations)
+	if(parseInt(pos,end,&board->rows) < 1){
+		return "error getting rows from file";
+	}
+	if(parseInt(pos,end,&board->cols) < 1){
+		return "error getting columns from file";
+	}
+	if(parseInt(pos,end,&board->iterations) < 1){
+		return "error getting iterations from file";
+	}
+	return NULL;
+}
+
+/**
+ * Splits the live cells of the file into chunks ending at whitespace and
+ * parses them, chunk 0 on the calling thread and the others on threads of
+ * their own
+ * @param chunks: the chunks, one per thread
+ * @param numChunks: the number of chunks
+ * @param beg: the first byte after the header
+ * @param end: one past the last byte of the file
+ * @return nothing
+ * @throws exit(1) if the threads can not be created
+ */
+static void parseChunks(parseChunk* chunks, int numChunks, const char* beg,
+	const char* end){
+	pthread_t* threadID;
+	const char* split;
+	int i;
+
+	threadID = (pthread_t*) malloc(numChunks * sizeof(pthread_t));
+	if(threadID == NULL){
+		printf("%s", "error allocating threads");
+		exit(1);
+	}
+	for(i = 0; i < numChunks; i++){
+		chunks[i].beg = i == 0 ? beg : chunks[i-1].end;
+		split = beg + (end - beg) / numChunks * (i + 1);
+		if(i == numChunks - 1 || split < chunks[i].beg){
+			split = i == numChunks - 1 ? end : chunks[i].beg;
+		}
+		//a number is never split between two chunks
+		while(split < end && !isSpace(*split)){
+			split++;
+		}
+		chunks[i].end = split;
+	}
+	for(i = 1; i < numChunks; i++){
+		if(pthread_create(&threadID[i],NULL,parseChunkValues,
+			&chunks[i]) != 0){
+			printf("%s", "error creating threads");
+			exit(1);
+		}
+	}
+	parseChunkValues(&chunks[0]);
+	for(i = 1; i < numChunks; i++){
+		pthread_join(threadID[i],NULL);
+	}
+	free(threadID);
+}
+
+/**
+ * Joins the integers of the chunks into the board's row, column pairs and
+ * checks that every cell is on the board
+ * @param board: the board, with its size read, gets the cells
+ * @param chunks: the parsed chunks
+ * @param numChunks: the number of chunks
+ * @return: NULL on success, the error otherwise
+ * @throws exit(1) if the cells can not be allocated
+ */
+static const char* joinChunks(boardFile* board, parseChunk* chunks,
+	int numChunks){
+	size_t total = 0;
+	size_t i;
+	int c;
+
+	for(c = 0; c < numChunks; c++){
+		if(chunks[c].error != NULL){
+			return chunks[c].error;
+		}
+		total += chunks[c].count;
+	}
+	if(total % 2 != 0){
+		return "error reading file";
+	}
+	if(total / 2 > INT_MAX){
+		return "too many live cells in file";
+	}
+	free(board->cells);
+	board->cells = (int*) malloc((total + 2) * sizeof(int));
+	if(board->cells == NULL){
+		printf("%s", "error allocating cells");
+		exit(1);
+	}
+	total = 0;
+	for(c = 0; c < numChunks; c++){
+		memcpy(board->cells + total, chunks[c].values,
+			chunks[c].count * sizeof(int));
+		total += chunks[c].count;
+	}
+	board->numCells = total / 2;
+	for(i = 0; i < total; i += 2){
+		if(board->cells[i] < 0 || board->cells[i] >= board->rows ||
+			board->cells[i+1] < 0 || board->cells[i+1] >= board->cols){
+			return "live cell outside of the board in file";
+		}
+	}
+	return NULL;
+}
+
+/**
+ * Picks the format of a file from its first characters
+ * @param pos: the start of the file
+ * @param end: one past the last byte of the file
+ * @return: one of the FORMAT_ values other than FORMAT_AUTO
+ */
+static int detectFormat(const char* pos, const char* end){
+	while(pos < end && isSpace(*pos)){
+		pos++;
+	}
+	if(end - pos >= 10 && memcmp(pos, "#Life 1.06", 10) == 0){
+		return FORMAT_LIFE106;
+	}
+	if(pos < end && (*pos == '!' || *pos == '.' || *pos == 'O' ||
+		*pos == '*')){
+		return FORMAT_CELLS;
+	}
+	if(pos < end && (*pos == '#' || *pos == 'x')){
+		return FORMAT_RLE;
+	}
+	return FORMAT_PAIRS;
+}
+
+/**
+ * Sets a run of cells of a row of a bit-packed board alive, a word at a time
+ * @param words: the words of the row
+ * @param col: the first column of the run
+ * @param count: the number of cells of the run
+ * @return nothing
+ */
+static void setCellRun(uint64_t* words, int col, int count){
+	int end = col + count;
+	int bit, bits;
+
+	while(col < end){
+		bit = col % BITS_PER_WORD;
+		bits = BITS_PER_WORD - bit < end - col ? BITS_PER_WORD - bit :
+			end - col;
+		words[col / BITS_PER_WORD] |= (bits == BITS_PER_WORD ? ~0ULL :
+			((1ULL << bits) - 1)) << bit;
+		col += bits;
+	}
+}
+
+/**
+ * Sets up the board a pattern is decoded into, the pattern's size or the
+ * size asked for with the pattern centered on it
+ * @param board: gets the size, the iterations and the bit-packed board
+ * @param fopts: the board size and iterations asked for
+ * @param height: the rows of the pattern
+ * @param width: the columns of the pattern
+ * @param rowOffset: set to the board row of the pattern's row 0
+ * @param colOffset: set to the board column of the pattern's column 0
+ * @return: NULL on success, the error otherwise
+ * @throws exit(1) if the board can not be allocated
+ */
+static const char* initializePattern(boardFile* board,
+	const fileOptions* fopts, long long height, long long width,
+	int* rowOffset, int* colOffset){
+	if(fopts->iterations < 0){
+		return "pattern files need --iterations";
+	}
+	if(height <= 0 || width <= 0){
+		if(fopts->rows == 0){
+			return "empty pattern in file, give the size with --board";
+		}
+		height = 0;
+		width = 0;
+	}
+	if(height > INT_MAX || width > INT_MAX ||
+		(fopts->rows > 0 && (height > fopts->rows || width > fopts->cols))){
+		return "pattern does not fit on the board";
+	}
+	board->rows = fopts->rows > 0 ? fopts->rows : (int) height;
+	board->cols = fopts->rows > 0 ? fopts->cols : (int) width;
+	board->iterations = fopts->iterations;
+	*rowOffset = (board->rows - (int) height) / 2;
+	*colOffset = (board->cols - (int) width) / 2;
+	board->bits = initializeCheckpoint(board->rows,board->cols,0);
+	return NULL;
+}
+
+/**
+ * Counts the live cells of a pattern's board into the board's numCells and
+ * the checkpoint's live count
+ * @param board: the board of the pattern
+ * @return: NULL on success, the error otherwise
+ */
+static const char* countPattern(boardFile* board){
+	size_t words = (size_t) board->bits->rows * board->bits->words;
+	long long live = 0;
+	size_t i;
+
+	for(i = 0; i < words; i++){
+		live += __builtin_popcountll(board->bits->bits[i]);
+	}
+	if(live > INT_MAX){
+		return "too many live cells in file";
+	}
+	board->numCells = (int) live;
+	board->bits->liveCount = live;
+	return NULL;
+}
+
+/**
+ * Reads the x = cols, y = rows[, rule = B3/S23] line of an RLE file
+ * @param pos: the start of the line, moved past it
+ * @param end: one past the last byte of the file
+ * @param height: set to the rows of the pattern
+ * @param width: set to the columns of the pattern
+ * @return: NULL on success, the error otherwise
+ */
+static const char* readRleHeader(const char** pos, const char* end,
+	int* height, int* width){
+	const char* line = *pos;
+	const char* lineEnd = nextLine(line,end);
+	const char* key;
+	const char* value;
+	const char* valueEnd;
+	char rule[32];
+	size_t length;
+	int number;
+	int found = 0;
+
+	*pos = lineEnd;
+	while(line < lineEnd){
+		while(line < lineEnd && (isSpace(*line) || *line == ',')){
+			line++;
+		}
+		if(line == lineEnd){
+			break;
+		}
+		key = line;
+		while(line < lineEnd && *line != '=' && !isSpace(*line)){
+			line++;
+		}
+		length = line - key;
+		while(line < lineEnd && isSpace(*line)){
+			line++;
+		}
+		if(line == lineEnd || *line != '='){
+			return "error getting pattern size from file";
+		}
+		value = ++line;
+		while(line < lineEnd && *line != ','){
+			line++;
+		}
+		valueEnd = line;
+		if(length == 1 && (*key == 'x' || *key == 'y')){
+			if(parseInt(&value,valueEnd,&number) < 1 || number < 0){
+				return "error getting pattern size from file";
+			}
+			*(*key == 'x' ? width : height) = number;
+			found |= *key == 'x' ? 1 : 2;
+		}
+		else if(length == 4 && strncmp(key, "rule", 4) == 0){
+			length = 0;
+			while(value < valueEnd && length < sizeof(rule) - 1){
+				if(!isSpace(*value)){
+					rule[length++] = *value >= 'a' && *value <= 'z' ?
+						*value - 'a' + 'A' : *value;
+				}
+				value++;
+			}
+			rule[length] = '\0';
+			if(strcmp(rule, "B3/S23") != 0 && strcmp(rule, "23/3") != 0){
+				return "unsupported rule in file";
+			}
+		}
+	}
+	return found == 3 ? NULL : "error getting pattern size from file";
+}
+
+/**
+ * Decodes an RLE pattern: # comment lines, the size line, then runs of
+ * [count]b dead cells and [count]o live cells, [count]$ ending rows, up to
+ * a ! at the end
+ * @param board: gets the size, iterations and board of the pattern
+ * @param fopts: the board size and iterations asked for
+ * @param pos: the start of the file
+ * @param end: one past the last byte of the file
+ * @return: NULL on success, the error otherwise
+ * @throws exit(1) if the board can not be allocated
+ */
+static const char* readRleFile(boardFile* board, const fileOptions* fopts,
+	const char* pos, const char* end){
+	const char* error;
+	int height = 0;
+	int width = 0;
+	int rowOffset, colOffset;
+	int row = 0;
+	int col = 0;
+	long long count;
+
+	pos = skipLines(pos,end,'#');
+	if(pos == end || *pos != 'x'){
+		return "error getting pattern size from file";
+	}
+	error = readRleHeader(&pos,end,&height,&width);
+	if(error == NULL){
+		error = initializePattern(board,fopts,height,width,&rowOffset,
+			&colOffset);
+	}
+	if(error != NULL){
+		return error;
+	}
+	while(pos < end && *pos != '!'){
+		if(isSpace(*pos)){
+			pos++;
+			continue;
+		}
+		count = 1;
+		if(*pos >= '0' && *pos <= '9'){
+			count = 0;
+			while(pos < end && *pos >= '0' && *pos <= '9'){
+				count = count * 10 + (*pos++ - '0');
+				if(count > INT_MAX){
+					return "error reading file";
+				}
+			}
+			while(pos < end && isSpace(*pos)){
+				pos++;
+			}
+			if(pos == end){
+				return "error reading file";
+			}
+		}
+		if(*pos == 'b' || *pos == '.'){
+			col = col + count > width ? width : col + (int) count;
+		}
+		else if(*pos == 'o' || *pos == 'A'){
+			if(row >= height || col + count > width){
+				return "live cell outside of the pattern in file";
+			}
+			setCellRun(board->bits->bits + (size_t) (row + rowOffset) *
+				board->bits->words,col + colOffset,(int) count);
+			col += (int) count;
+		}
+		else if(*pos == '$'){
+			row = row + count > height ? height : row + (int) count;
+			col = 0;
+		}
+		else{
+			return "error reading file";
+		}
+		pos++;
+	}
+	return countPattern(board);
+}
+
+/**
+ * Decodes a Life 1.06 pattern: # lines then an x y pair, column then row,
+ * per live cell. The pairs are read twice, once for the pattern's bounds
+ * and once to set the cells.
+ * @param board: gets the size, iterations and board of the pattern
+ * @param fopts: the board size and iterations asked for
+ * @param pos: the start of the file
+ * @param end: one past the last byte of the file
+ * @return: NULL on success, the error otherwise
+ * @throws exit(1) if the board can not be allocated
+ */
+static const char* readLife106File(boardFile* board,
+	const fileOptions* fopts, const char* pos, const char* end){
+	const char* error;
+	const char* cells;
+	long long minRow = 0, maxRow = -1, minCol = 0, maxCol = -1;
+	int rowOffset, colOffset;
+	int x, y;
+	int found;
+
+	cells = skipLines(pos,end,'#');
+	pos = cells;
+	while((found = parseInt(&pos,end,&x)) == 1){
+		if(parseInt(&pos,end,&y) < 1){
+			return "error reading file";
+		}
+		if(maxRow < minRow){
+			minRow = maxRow = y;
+			minCol = maxCol = x;
+		}
+		minRow = y < minRow ? y : minRow;
+		maxRow = y > maxRow ? y : maxRow;
+		minCol = x < minCol ? x : minCol;
+		maxCol = x > maxCol ? x : maxCol;
+	}
+	if(found < 0){
+		return "error reading file";
+	}
+	error = initializePattern(board,fopts,maxRow - minRow + 1,
+		maxCol - minCol + 1,&rowOffset,&colOffset);
+	if(error != NULL){
+		return error;
+	}
+	pos = cells;
+	while(parseInt(&pos,end,&x) == 1 && parseInt(&pos,end,&y) == 1){
+		setCellRun(board->bits->bits + (size_t) (y - minRow + rowOffset) *
+			board->bits->words,(int) (x - minCol) + colOffset,1);
+	}
+	return countPattern(board);
+}
+
+/**
+ * Decodes a plaintext pattern: ! comment lines, then one line per row with
+ * . (or a space) for a dead cell and O (or *) for a live one. Lines may be
+ * shorter than the pattern, the rest of the row is dead.
+ * @param board: gets the size, iterations and board of the pattern
+ * @param fopts: the board size and iterations asked for
+ * @param pos: the start of the file
+ * @param end: one past the last byte of the file
+ * @return: NULL on success, the error otherwise
+ * @throws exit(1) if the board can not be allocated
+ */
+static const char* readCellsFile(boardFile* board, const fileOptions* fopts,
+	const char* pos, const char* end){
+	const char* error;
+	const char* line;
+	const char* lineEnd;
+	int rowOffset, colOffset;
+	long long width = 0;
+	long long height = 0;
+	long long lines = 0;
+	int row = 0;
+	int col;
+
+	//the first pass only measures the pattern
+	for(line = pos; line < end; line = nextLine(line,end)){
+		if(*line == '!'){
+			continue;
+		}
+		lines++;
+		lineEnd = line;
+		while(lineEnd < end && *lineEnd != '\n' && *lineEnd != '\r'){
+			if(*lineEnd != '.' && *lineEnd != ' ' && *lineEnd != 'O' &&
+				*lineEnd != '*'){
+				return "error reading file";
+			}
+			lineEnd++;
+		}
+		while(lineEnd > line && lineEnd[-1] == ' '){
+			lineEnd--;
+		}
+		if(lineEnd > line){
+			height = lines;
+			width = lineEnd - line > width ? lineEnd - line : width;
+		}
+	}
+	error = initializePattern(board,fopts,height,width,&rowOffset,
+		&colOffset);
+	if(error != NULL){
+		return error;
+	}
+	for(line = pos; line < end && row < height; line = nextLine(line,end)){
+		if(*line == '!'){
+			continue;
+		}
+		for(col = 0; line + col < end && line[col] != '\n' &&
+			line[col] != '\r'; col++){
+			if(line[col] == 'O' || line[col] == '*'){
+				setCellRun(board->bits->bits + (size_t) (row + rowOffset) *
+					board->bits->words,col + colOffset,1);
+			}
+		}
+		row++;
+	}
+	return countPattern(board);
+}
+
+/**
+ * Reads a file of row, column pairs, splitting the live cells between
+ * parsing threads
+ * @param board: gets the size, iterations and cells of the file
+ * @param fopts: the iterations asked for
+ * @param pos: the start of the file
+ * @param end: one past the last byte of the file
+ * @param numThreads: the most threads to parse the live cells with
+ * @return: NULL on success, the error otherwise
+ * @throws exit(1) if the cells can not be allocated
+ */
+static const char* readPairsFile(boardFile* board, const fileOptions* fopts,
+	const char* pos, const char* end, int numThreads){
+	const char* error;
+	int numChunks;
+	int i;
+	parseChunk* chunks;
+
+	if(fopts->rows > 0){
+		return "--board only applies to pattern files";
+	}
+	error = getSizeIterations(board,&pos,end);
+	if(error != NULL){
+		return error;
+	}
+	if(fopts->iterations >= 0){
+		board->iterations = fopts->iterations;
+	}
+	numChunks = (end - pos) / PARSE_CHUNK + 1;
+	numChunks = numChunks < numThreads ? numChunks : numThreads;
+	numChunks = numChunks > 0 ? numChunks : 1;
+	chunks = (parseChunk*) calloc(numChunks, sizeof(parseChunk));
+	if(chunks == NULL){
+		printf("%s", "error allocating cells");
+		exit(1);
+	}
+	parseChunks(chunks,numChunks,pos,end);
+	error = joinChunks(board,chunks,numChunks);
+	for(i = 0; i < numChunks; i++){
+		free(chunks[i].values);
+	}
+	free(chunks);
+	return error;
+}
+
+/**
+ * Fills in the default file options: the format detected from the file,
+ * the pattern's own size and the file's iterations
+ * @param fopts: the options to fill in
+ * @return nothing
+ */
+void defaultFileOptions(fileOptions* fopts){
+	fopts->format = FORMAT_AUTO;
+	fopts->rows = 0;
+	fopts->cols = 0;
+	fopts->iterations = -1;
+}
+
+/**
+ * Reads one optional argument about the input file, --format, --board=RxC
+ * or --iterations with its value, into fopts
+ * @param fopts: the options to change
+ * @param arg: the argument, for example "--format=rle"
+ * @param error: set to why the argument is invalid, NULL if it was read
+ * @return: 1 if the argument is a file option, 0 if it is not
+ */
+int parseFileOption(fileOptions* fopts, const char* arg, const char** error){
+	const char* value;
+	char* sizeEnd;
+	long rows, cols;
+
+	*error = NULL;
+	if(strncmp(arg,"--format=",9) == 0){
+		value = arg + 9;
+		if(strcmp(value,"auto") == 0){
+			fopts->format = FORMAT_AUTO;
+		}
+		else if(strcmp(value,"pairs") == 0){
+			fopts->format = FORMAT_PAIRS;
+		}
+		else if(strcmp(value,"rle") == 0){
+			fopts->format = FORMAT_RLE;
+		}
+		else if(strcmp(value,"life106") == 0){
+			fopts->format = FORMAT_LIFE106;
+		}
+		else if(strcmp(value,"cells") == 0){
+			fopts->format = FORMAT_CELLS;
+		}
+		else{
+			*error = "invalid format argument";
+		}
+	}
+	else if(strncmp(arg,"--board=",8) == 0){
+		value = arg + 8;
+		rows = *value >= '0' && *value <= '9' ?
+			strtol(value,&sizeEnd,10) : 0;
+		cols = rows > 0 && *sizeEnd == 'x' && sizeEnd[1] >= '0' &&
+			sizeEnd[1] <= '9' ? strtol(sizeEnd + 1,&sizeEnd,10) : 0;
+		if(rows <= 0 || cols <= 0 || rows > INT_MAX || cols > INT_MAX ||
+			*sizeEnd != '\0'){
+			*error = "invalid board argument";
+		}
+		else{
+			fopts->rows = (int) rows;
+			fopts->cols = (int) cols;
+		}
+	}
+	else if(strncmp(arg,"--iterations=",13) == 0){
+		value = arg + 13;
+		if(*value == '\0' || strlen(value) > 9 ||
+			strspn(value,"0123456789") != strlen(value)){
+			*error = "invalid iterations argument";
+		}
+		else{
+			fopts->iterations = atoi(value);
+		}
+	}
+	else{
+		return 0;
+	}
+	return 1;
+}
+
+/**
+ * Reads a whole input file
+ * @param inFile: FILE ptr that has opened the file, read from its start and
+ *                left open
+ * @param board: filled in with the file's contents, must be freed with
+ *               freeBoardFile even if the file is invalid
+ * @param fopts: the format of the file, and the board size and iterations
+ *               of a pattern
+ * @param numThreads: the most threads to parse the live cells with, a file
+ *                    of pairs gets one per PARSE_CHUNK bytes
+ * @returns: NULL on success, the error otherwise
+ * @throws exit(1) if the data, the cells or the board can not be allocated
+ */
+const char* readBoardFile(FILE* inFile, boardFile* board,
+	const fileOptions* fopts, int numThreads){
+	const char* error;
+	const char* end;
+	char* data;
+	size_t size;
+	int mapped;
+	int format;
+
+	board->numCells = 0;
+	board->cells = NULL;
+	board->bits = NULL;
+	data = loadFileData(inFile,&size,&mapped);
+	end = data + size;
+	format = fopts->format;
+	if(format == FORMAT_AUTO){
+		format = detectFormat(data,end);
+	}
+	if(format == FORMAT_RLE){
+		error = readRleFile(board,fopts,data,end);
+	}
+	else if(format == FORMAT_LIFE106){
+		error = readLife106File(board,fopts,data,end);
+	}
+	else if(format == FORMAT_CELLS){
+		error = readCellsFile(board,fopts,data,end);
+	}
+	else{
+		error = readPairsFile(board,fopts,data,end,numThreads);
+	}
+	if(mapped){
+		munmap(data, size);
+	}
+	else{
+		free(data);
+	}
+	return error;
+}
+
+/**
+ * Frees the cells read from a file
+ * @param board: the file's contents
+ * @return nothing
+ */
+void freeBoardFile(boardFile* board){
+	free(board->cells);
+	board->cells = NULL;
+	freeCheckpoint(board->bits);
+	board->bits = NULL;
+}
+
+/**
+ * Returns the first column from a column on whose cell is in a state
+ * @param cp: the board
+ * @param row: the row to search
+ * @param col: the column to start at
+ * @param alive: 1 to find a live cell, 0 to find a dead one
+ * @return: the column, or the number of columns if there is none
+ */
+static int nextCellState(const checkpoint* cp, int row, int col, int alive){
+	const uint64_t* words = cp->bits + (size_t) row * cp->words;
+	uint64_t word;
+	int w = col / BITS_PER_WORD;
+
+	if(col >= cp->cols){
+		return cp->cols;
+	}
+	word = (alive ? words[w] : ~words[w]) >> (col % BITS_PER_WORD);
+	if(word != 0){
+		col += __builtin_ctzll(word);
+		return col < cp->cols ? col : cp->cols;
+	}
+	for(w++; w < cp->words; w++){
+		word = alive ? words[w] : ~words[w];
+		if(word != 0){
+			col = w * BITS_PER_WORD + __builtin_ctzll(word);
+			return col < cp->cols ? col : cp->cols;
+		}
+	}
+	return cp->cols;
+}
+
+/**
+ * Writes one run of an RLE body, starting a new line before it would pass
+ * RLE_LINE characters
+ * @param outFile: the file
+ * @param count: the length of the run
+ * @param tag: b, o or $
+ * @param lineLength: the characters on the current line, updated
+ * @return nothing
+ */
+static void writeRleRun(FILE* outFile, long long count, char tag,
+	int* lineLength){
+	char run[24];
+	int length;
+
+	if(count == 1){
+		length = sprintf(run, "%c", tag);
+	}
+	else{
+		length = sprintf(run, "%lld%c", count, tag);
+	}
+	if(*lineLength + length > RLE_LINE){
+		fputc('\n', outFile);
+		*lineLength = 0;
+	}
+	fputs(run, outFile);
+	*lineLength += length;
+}
+
+/**
+ * Writes a board as an RLE pattern of the board's size. Dead cells at the
+ * end of a row are left out and empty rows are merged into the $ run.
+ * @param outFile: the file to write to
+ * @param cp: the board, for example from snapshotSimulator
+ * @return: 0 on success, -1 if the file could not be written
+ */
+int writeRleFile(FILE* outFile, const checkpoint* cp){
+	int lineLength = 0;
+	int lastRow = 0;
+	int row, col, next;
+
+	fprintf(outFile, "#C Generation %d\n", cp->generation);
+	fprintf(outFile, "x = %d, y = %d, rule = B3/S23\n", cp->cols, cp->rows);
+	for(row = 0; row < cp->rows; row++){
+		col = nextCellState(cp,row,0,1);
+		if(col == cp->cols){
+			continue;
+		}
+		if(row > lastRow){
+			writeRleRun(outFile,row - lastRow,'$',&lineLength);
+		}
+		lastRow = row;
+		if(col > 0){
+			writeRleRun(outFile,col,'b',&lineLength);
+		}
+		while(col < cp->cols){
+			next = nextCellState(cp,row,col,0);
+			writeRleRun(outFile,next - col,'o',&lineLength);
+			col = nextCellState(cp,row,next,1);
+			if(col < cp->cols){
+				writeRleRun(outFile,col - next,'b',&lineLength);
+			}
+		}
+	}
+	fputs("!\n", outFile);
+	return ferror(outFile) ? -1 : 0;
+}
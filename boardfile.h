@@ -0,0 +1,51 @@
+//boardfile.h
+//Description: Reader of the input file. The native format is the number of
+//             rows, the number of columns and the number of iterations,
+//             followed by a row, column pair for every live cell of the
+//             initial state. Every live cell must be on the board.
+//             Patterns in the community formats, RLE, Life 1.06 and
+//             plaintext (.cells), are read too and the final board can be
+//             written as RLE. A pattern has no number of iterations and its
+//             board is the pattern's size unless a larger one is asked for,
+//             in which case the pattern is centered on it.
+
+#ifndef BOARDFILE_H
+#define BOARDFILE_H
+
+#include <stdio.h>
+#include "checkpoint.h"
+
+#define FORMAT_AUTO 0 // picked from the start of the file
+#define FORMAT_PAIRS 1 // rows, cols, iterations then row, column pairs
+#define FORMAT_RLE 2 // run length encoded pattern, x = cols, y = rows
+#define FORMAT_LIFE106 3 // #Life 1.06 header then an x y pair per live cell
+#define FORMAT_CELLS 4 // plaintext, one line per row, . dead and O alive
+
+typedef struct fileOptions{
+	int format; // One of the FORMAT_ values
+	int rows; // Rows of the board of a pattern, 0 for the pattern's
+	int cols; // Columns of the board of a pattern, 0 for the pattern's
+	int iterations; // Number of iterations to run, -1 for the file's
+} fileOptions;
+
+typedef struct boardFile{
+	int rows; // Number of rows in the grid
+	int cols; // Number of columns in the grid
+	int iterations; // Number of iterations to run
+	int* cells; // Row, column pairs of the live cells (pairs format)
+	int numCells; // Number of pairs in cells, or live cells of a pattern
+	checkpoint* bits; // The board of a pattern, NULL for the pairs format
+} boardFile;
+
+void defaultFileOptions(fileOptions* fopts);
+
+int parseFileOption(fileOptions* fopts, const char* arg, const char** error);
+
+const char* readBoardFile(FILE* inFile, boardFile* board,
+	const fileOptions* fopts, int numThreads);
+
+void freeBoardFile(boardFile* board);
+
+int writeRleFile(FILE* outFile, const checkpoint* cp);
+
+#endif /* BOARDFILE_H */
@@ -0,0 +1,303 @@
+//checkpoint.c
+//Description: Binary checkpoints of a board. The file is a fixed header
+//             followed by the bit-packed rows, in the byte order of the
+//             machine that wrote it, which is checked on load. The header is
+//             a multiple of 8 bytes, so a mapped body is aligned for its
+//             words and is read in place.
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "bitboard.h"
+#include "checkpoint.h"
+
+#define CHECKPOINT_MAGIC "GOLCKPT1" // First 8 bytes of every checkpoint
+#define CHECKPOINT_BYTE_ORDER 0x01020304 // Reads back the same on load
+
+typedef struct checkpointHeader{
+	char magic[8]; // CHECKPOINT_MAGIC
+	uint32_t byteOrder; // CHECKPOINT_BYTE_ORDER
+	uint32_t wrap; // 0 for nowrap 1 for wrap
+	int32_t rows; // Number of rows in the grid
+	int32_t cols; // Number of columns in the grid
+	int64_t generation; // Generation of the board
+	int64_t liveCount; // Live cells in the board
+	int64_t totalLiveCount; // Live cells summed up to the generation
+} checkpointHeader;
+
+/**
+ * Allocates an empty checkpoint of the given size
+ * @param row: the number of rows
+ * @param col: the number of columns
+ * @param wrap: 0 for nowrap 1 for wrap
+ * @return: the checkpoint, every cell dead and every count 0
+ * @throws exit(1) if the checkpoint can not be allocated
+ */
+checkpoint* initializeCheckpoint(int row, int col, int wrap){
+	checkpoint* cp;
+
+	cp = (checkpoint*) malloc(sizeof(checkpoint));
+	if(cp == NULL){
+		printf("%s", "error allocating checkpoint");
+		exit(1);
+	}
+	memset(cp, 0, sizeof(checkpoint));
+	cp->rows = row;
+	cp->cols = col;
+	cp->words = (col + BITS_PER_WORD - 1) / BITS_PER_WORD;
+	cp->wrap = wrap;
+	cp->bits = (uint64_t*) calloc((size_t) row * cp->words, sizeof(uint64_t));
+	if(cp->bits == NULL){
+		printf("%s", "error allocating checkpoint");
+		exit(1);
+	}
+	return cp;
+}
+
+/**
+ * Frees a checkpoint, unmapping it if it was loaded from a file
+ * @param cp: the checkpoint, may be NULL
+ * @return nothing
+ */
+void freeCheckpoint(checkpoint* cp){
+	if(cp == NULL){
+		return;
+	}
+	if(cp->map != NULL){
+		munmap(cp->map, cp->mapSize);
+	}
+	else{
+		free(cp->bits);
+	}
+	free(cp);
+}
+
+/**
+ * Returns the state of a cell of a checkpoint
+ * @param cp: the checkpoint
+ * @param row: the row of the cell
+ * @param col: the column of the cell
+ * @return: 1 if the cell is alive, 0 if it is dead
+ */
+int getCheckpointCell(const checkpoint* cp, int row, int col){
+	return (cp->bits[(size_t) row * cp->words + col / BITS_PER_WORD] >>
+		(col % BITS_PER_WORD)) & 1;
+}
+
+/**
+ * Writes a checkpoint to a file. It is written to fileName.tmp, synced and
+ * renamed over fileName, so the file always holds a complete checkpoint.
+ * @param cp: the checkpoint
+ * @param fileName: the name of the file
+ * @return: 0 on success, -1 if the file could not be written
+ */
+int saveCheckpoint(const checkpoint* cp, const char* fileName){
+	checkpointHeader header;
+	char* tmpName;
+	size_t words = (size_t) cp->rows * cp->words;
+	FILE* outFile;
+	int failed;
+
+	tmpName = (char*) malloc(strlen(fileName) + 5);
+	if(tmpName == NULL){
+		return -1;
+	}
+	sprintf(tmpName, "%s.tmp", fileName);
+	outFile = fopen(tmpName, "wb");
+	if(outFile == NULL){
+		free(tmpName);
+		return -1;
+	}
+	memset(&header, 0, sizeof(header));
+	memcpy(header.magic, CHECKPOINT_MAGIC, sizeof(header.magic));
+	header.byteOrder = CHECKPOINT_BYTE_ORDER;
+	header.wrap = cp->wrap;
+	header.rows = cp->rows;
+	header.cols = cp->cols;
+	header.generation = cp->generation;
+	header.liveCount = cp->liveCount;
+	header.totalLiveCount = cp->totalLiveCount;
+	failed = fwrite(&header, sizeof(header), 1, outFile) != 1 ||
+		fwrite(cp->bits, sizeof(uint64_t), words, outFile) != words ||
+		fflush(outFile) != 0 || fsync(fileno(outFile)) != 0;
+	failed = fclose(outFile) != 0 || failed;
+	if(failed || rename(tmpName, fileName) != 0){
+		remove(tmpName);
+		free(tmpName);
+		return -1;
+	}
+	free(tmpName);
+	return 0;
+}
+
+/**
+ * Maps a checkpoint file into memory. The body is not copied, the bits of
+ * the checkpoint point into the mapping until it is freed.
+ * @param fileName: the name of the file
+ * @param error: set to why the file could not be loaded
+ * @return: the checkpoint, NULL if the file could not be loaded
+ * @throws exit(1) if the checkpoint can not be allocated
+ */
+checkpoint* loadCheckpoint(const char* fileName, const char** error){
+	checkpointHeader header;
+	struct stat info;
+	checkpoint* cp;
+	char* data;
+	int fd;
+	int words;
+
+	fd = open(fileName, O_RDONLY);
+	if(fd < 0){
+		*error = "Error opening checkpoint.";
+		return NULL;
+	}
+	if(fstat(fd, &info) != 0 || info.st_size < (off_t) sizeof(header)){
+		close(fd);
+		*error = "invalid checkpoint file";
+		return NULL;
+	}
+	data = (char*) mmap(NULL, info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+	close(fd);
+	if(data == MAP_FAILED){
+		*error = "error reading checkpoint";
+		return NULL;
+	}
+	memcpy(&header, data, sizeof(header));
+	words = header.cols > 0 ?
+		(header.cols + BITS_PER_WORD - 1) / BITS_PER_WORD : 0;
+	if(memcmp(header.magic, CHECKPOINT_MAGIC, sizeof(header.magic)) != 0 ||
+		header.byteOrder != CHECKPOINT_BYTE_ORDER || header.rows <= 0 ||
+		header.cols <= 0 || header.generation < 0 ||
+		header.generation > 0x7fffffff ||
+		(size_t) info.st_size != sizeof(header) +
+		(size_t) header.rows * words * sizeof(uint64_t)){
+		munmap(data, info.st_size);
+		*error = "invalid checkpoint file";
+		return NULL;
+	}
+	madvise(data, info.st_size, MADV_SEQUENTIAL);
+	cp = (checkpoint*) malloc(sizeof(checkpoint));
+	if(cp == NULL){
+		printf("%s", "error allocating checkpoint");
+		exit(1);
+	}
+	cp->rows = header.rows;
+	cp->cols = header.cols;
+	cp->words = words;
+	cp->wrap = header.wrap != 0;
+	cp->generation = (int) header.generation;
+	cp->liveCount = header.liveCount;
+	cp->totalLiveCount = header.totalLiveCount;
+	cp->tilesProcessed = 0;
+	cp->tileCount = 0;
+	cp->bits = (uint64_t*) (data + sizeof(header));
+	cp->map = data;
+	cp->mapSize = info.st_size;
+	return cp;
+}
+
+/**
+ * Driver function of the writer thread. Writes the pending checkpoint until
+ * it is told to quit and nothing is pending.
+ * @param arguments: pointer to the checkpointWriter
+ * @return NULL
+ */
+static void* runCheckpointWriter(void* arguments){
+	checkpointWriter* writer = (checkpointWriter*) arguments;
+	checkpoint* cp;
+	int failed;
+
+	pthread_mutex_lock(&writer->lock);
+	while(1){
+		while(writer->pending == NULL && !writer->quit){
+			pthread_cond_wait(&writer->changed, &writer->lock);
+		}
+		if(writer->pending == NULL){
+			break;
+		}
+		cp = writer->pending;
+		writer->pending = NULL;
+		pthread_mutex_unlock(&writer->lock);
+		failed = saveCheckpoint(cp, writer->fileName) != 0;
+		freeCheckpoint(cp);
+		pthread_mutex_lock(&writer->lock);
+		writer->failures += failed;
+	}
+	pthread_mutex_unlock(&writer->lock);
+	return NULL;
+}
+
+/**
+ * Starts a thread that writes queued checkpoints to a file
+ * @param fileName: the name of the file, copied
+ * @return: the writer
+ * @throws exit(1) if the writer can not be allocated or its thread created
+ */
+checkpointWriter* startCheckpointWriter(const char* fileName){
+	checkpointWriter* writer;
+
+	writer = (checkpointWriter*) malloc(sizeof(checkpointWriter));
+	if(writer == NULL){
+		printf("%s", "error allocating checkpoint writer");
+		exit(1);
+	}
+	writer->pending = NULL;
+	writer->quit = 0;
+	writer->failures = 0;
+	writer->fileName = strdup(fileName);
+	if(writer->fileName == NULL){
+		printf("%s", "error allocating checkpoint writer");
+		exit(1);
+	}
+	pthread_mutex_init(&writer->lock, NULL);
+	pthread_cond_init(&writer->changed, NULL);
+	if(pthread_create(&writer->thread,NULL,runCheckpointWriter,writer) != 0){
+		printf("%s", "error creating threads");
+		exit(1);
+	}
+	return writer;
+}
+
+/**
+ * Hands a checkpoint to the writer and returns at once. A checkpoint still
+ * waiting to be written is replaced, only the newest one is worth writing.
+ * @param writer: the writer
+ * @param cp: the checkpoint, freed by the writer
+ * @return nothing
+ */
+void queueCheckpoint(checkpointWriter* writer, checkpoint* cp){
+	checkpoint* old;
+
+	pthread_mutex_lock(&writer->lock);
+	old = writer->pending;
+	writer->pending = cp;
+	pthread_cond_signal(&writer->changed);
+	pthread_mutex_unlock(&writer->lock);
+	freeCheckpoint(old);
+}
+
+/**
+ * Writes the pending checkpoint, if any, ends the writer's thread and frees
+ * the writer
+ * @param writer: the writer
+ * @return: the number of checkpoints that could not be written
+ */
+int stopCheckpointWriter(checkpointWriter* writer){
+	int failures;
+
+	pthread_mutex_lock(&writer->lock);
+	writer->quit = 1;
+	pthread_cond_signal(&writer->changed);
+	pthread_mutex_unlock(&writer->lock);
+	pthread_join(writer->thread,NULL);
+	failures = writer->failures;
+	pthread_mutex_destroy(&writer->lock);
+	pthread_cond_destroy(&writer->changed);
+	free(writer->fileName);
+	free(writer);
+	return failures;
+}
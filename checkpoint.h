@@ -0,0 +1,60 @@
+//checkpoint.h
+//Description: Binary checkpoints of a board, to resume a long run after it
+//             was stopped. A checkpoint file is a header with the size,
+//             generation, wrap flag and live counts followed by the board
+//             bit-packed like a bitBoard, 64 cells per word and row by row.
+//             Files are written to a temporary name and renamed, so a run
+//             stopped while writing leaves the last complete checkpoint,
+//             and are loaded with mmap, the body is used where it lies.
+//             A checkpoint writer writes them on a thread of its own so the
+//             simulation goes on while a checkpoint is written.
+
+#ifndef CHECKPOINT_H
+#define CHECKPOINT_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <pthread.h>
+
+typedef struct checkpoint{
+	int rows; // Number of rows in the grid
+	int cols; // Number of columns in the grid
+	int words; // Number of words used by each row
+	int wrap; // 0 for nowrap 1 for wrap
+	int generation; // Generation of the board
+	long long liveCount; // Live cells in the board
+	long long totalLiveCount; // Live cells summed up to the generation
+	long long tilesProcessed; // Tiles recalculated in the last step, not saved
+	int tileCount; // Tiles of the active region, 0 for none, not saved
+	uint64_t* bits; // rows rows of words, bit j of word k is column 64k+j
+	void* map; // Mapping the checkpoint was loaded from, NULL if allocated
+	size_t mapSize; // Bytes of the mapping
+} checkpoint;
+
+typedef struct checkpointWriter{
+	pthread_t thread; // Thread writing the checkpoints
+	pthread_mutex_t lock; // Protects pending, quit and failures
+	pthread_cond_t changed; // Signaled when pending or quit change
+	checkpoint* pending; // Checkpoint to write next, NULL if none
+	int quit; // Set to end the thread once nothing is pending
+	int failures; // Number of checkpoints that could not be written
+	char* fileName; // File the checkpoints are written to
+} checkpointWriter;
+
+checkpoint* initializeCheckpoint(int row, int col, int wrap);
+
+void freeCheckpoint(checkpoint* cp);
+
+int getCheckpointCell(const checkpoint* cp, int row, int col);
+
+int saveCheckpoint(const checkpoint* cp, const char* fileName);
+
+checkpoint* loadCheckpoint(const char* fileName, const char** error);
+
+checkpointWriter* startCheckpointWriter(const char* fileName);
+
+void queueCheckpoint(checkpointWriter* writer, checkpoint* cp);
+
+int stopCheckpointWriter(checkpointWriter* writer);
+
+#endif /* CHECKPOINT_H */
@@ -0,0 +1,385 @@
+//distrib.c
+//Description: Distributed mode. The board is split into row bands like the
+//             row partition of the threads, one band per process (rank), so
+//             each process only holds its own rows. Every generation a rank
+//             starts the exchange of its edge rows with the ranks above and
+//             below, calculates the rows that do not need the halo while the
+//             rows travel, then the two edge rows. The live counts are summed
+//             over the ranks at the end and rank 0 prints them.
+//             Each rank runs the simd kernel on a thread of its own.
+//             Usage: ./distrib fileName numberOfProcesses wrap/nowrap
+//             [--format/--board/--iterations] [--simd=isa] [--output=name]
+//             Built with mpicc -DUSE_MPI it is started by mpirun with the
+//             same number of processes, otherwise it forks them itself.
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/time.h>
+#include "simulator.h"
+#include "boardfile.h"
+#include "board.h"
+#include "simd.h"
+#include "halo.h"
+
+typedef struct rankBand{
+	int begRow; // First row of the board in the band
+	int rows; // Number of rows in the band
+	int cols; // Number of columns in the grid
+	int words; // Number of words of a packed row
+	cellBoard* current; // The band, its halo rows are the neighbors' rows
+	cellBoard* next; // The band's next generation
+	uint64_t* top; // First row of the band, packed
+	uint64_t* bottom; // Last row of the band, packed
+	uint64_t* above; // Last row of the rank above, packed
+	uint64_t* below; // First row of the rank below, packed
+	simdRowFunc simdRow; // Row function of the simd kernel
+} rankBand;
+
+/**
+ * Packs a row of a board into bits, 64 cells per word
+ * @param board: the board
+ * @param row: the row, may be -1 or rows for the halo
+ * @param words: gets the row, bit j of word k is column 64k+j
+ * @param numWords: the number of words of the row
+ * @return nothing
+ */
+void packRow(const cellBoard* board, int row, uint64_t* words,
+	int numWords){
+	const cell* cells = ROW(board,row);
+	int col;
+
+	memset(words, 0, numWords * sizeof(uint64_t));
+	for(col = 0; col < board->cols; col++){
+		words[col >> 6] |= (uint64_t) (cells[col] & 1) << (col & 63);
+	}
+}
+
+/**
+ * Unpacks a row of bits into a halo row of a board, with its halo columns
+ * @param board: the board
+ * @param row: the halo row, -1 or rows
+ * @param words: the packed row
+ * @param wrap: 0 for nowrap 1 for wrap
+ * @return nothing
+ */
+void unpackRow(cellBoard* board, int row, const uint64_t* words, int wrap){
+	cell* cells = ROW(board,row);
+	int col;
+
+	for(col = 0; col < board->cols; col++){
+		cells[col] = (cell) (words[col >> 6] >> (col & 63)) & 1;
+	}
+	if(wrap){
+		cells[-1] = cells[board->cols-1];
+		cells[board->cols] = cells[0];
+	}
+}
+
+/**
+ * Copies the edge columns of rows of a board into its halo columns, for
+ * wrap
+ * @param board: the board
+ * @param begRow: the first row
+ * @param endRow: one past the last row
+ * @return nothing
+ */
+void refreshColumns(cellBoard* board, int begRow, int endRow){
+	int row;
+
+	for(row = begRow; row < endRow; row++){
+		CELL(board,row,-1) = CELL(board,row,board->cols-1);
+		CELL(board,row,board->cols) = CELL(board,row,0);
+	}
+}
+
+/**
+ * Creates a rank's band of the board and sets its live cells
+ * @param band: gets the band
+ * @param board: the contents of the input file
+ * @param begRow: the first row of the band
+ * @param endRow: the last row of the band
+ * @param wrap: 0 for nowrap 1 for wrap
+ * @return: the number of live cells in the band
+ * @throws exit(1) if the band can not be allocated
+ */
+long long loadBand(rankBand* band, const boardFile* board, int begRow,
+	int endRow, int wrap){
+	long long liveCells = 0;
+	int i, row, col;
+
+	band->begRow = begRow;
+	band->rows = endRow - begRow + 1;
+	band->cols = board->cols;
+	band->words = (board->cols + 63) / 64;
+	band->current = initializeBoard(band->rows,band->cols);
+	band->next = initializeBoard(band->rows,band->cols);
+	band->top = (uint64_t*) malloc(4 * band->words * sizeof(uint64_t));
+	if(band->top == NULL){
+		printf("%s", "error allocating band");
+		exit(1);
+	}
+	band->bottom = band->top + band->words;
+	band->above = band->bottom + band->words;
+	band->below = band->above + band->words;
+	if(board->bits != NULL){
+		for(row = 0; row < band->rows; row++){
+			for(col = 0; col < band->cols; col++){
+				CELL(band->current,row,col) = getCheckpointCell(board->bits,
+					begRow + row,col);
+				liveCells += CELL(band->current,row,col);
+			}
+		}
+	}
+	else{
+		for(i = 0; i < board->numCells; i++){
+			row = board->cells[2*i] - begRow;
+			col = board->cells[2*i+1];
+			if(row >= 0 && row < band->rows &&
+				!CELL(band->current,row,col)){
+				CELL(band->current,row,col) = 1;
+				liveCells++;
+			}
+		}
+	}
+	if(wrap){
+		refreshColumns(band->current,0,band->rows);
+	}
+	return liveCells;
+}
+
+/**
+ * Calculates one generation of a rank's band. The halo exchange runs while
+ * the rows between the two edge rows are calculated.
+ * @param band: the band
+ * @param link: the links to the other ranks
+ * @param wrap: 0 for nowrap 1 for wrap
+ * @return: the number of live cells in the band's new generation
+ */
+long long stepBand(rankBand* band, haloLink* link, int wrap){
+	cellBoard* swap;
+	long long liveCells = 0;
+	int last = band->rows - 1;
+
+	packRow(band->current,0,band->top,band->words);
+	packRow(band->current,last,band->bottom,band->words);
+	startHaloExchange(link,band->top,band->bottom,band->above,band->below,
+		band->words,wrap);
+	if(band->rows > 2){
+		liveCells += calcNextSimdIteration(band->simdRow,band->current,
+			band->next,1,0,band->cols,last);
+	}
+	finishHaloExchange(link);
+	unpackRow(band->current,-1,band->above,wrap);
+	unpackRow(band->current,band->rows,band->below,wrap);
+	liveCells += calcNextSimdIteration(band->simdRow,band->current,
+		band->next,0,0,band->cols,1);
+	if(last > 0){
+		liveCells += calcNextSimdIteration(band->simdRow,band->current,
+			band->next,last,0,band->cols,band->rows);
+	}
+	if(wrap){
+		refreshColumns(band->next,0,band->rows);
+	}
+	swap = band->current;
+	band->current = band->next;
+	band->next = swap;
+	return liveCells;
+}
+
+/**
+ * Gathers every band on rank 0 and writes the board as RLE
+ * @param band: this rank's band
+ * @param link: the links to the other ranks
+ * @param rows: the number of rows of the board
+ * @param generation: the generation of the band
+ * @param wrap: 0 for nowrap 1 for wrap
+ * @param counts: the live count and the summed live counts of the board
+ * @param fileName: the file to write, on rank 0
+ * @return nothing
+ * @throws exit(1) if the file can not be written
+ */
+void writeOutput(rankBand* band, haloLink* link, int rows, int generation,
+	int wrap, const long long* counts, const char* fileName){
+	checkpoint* cp = NULL;
+	uint64_t* words;
+	size_t* wordCounts;
+	FILE* outFile;
+	int rank, beg, end, row;
+	int failed;
+
+	words = (uint64_t*) malloc((size_t) band->rows * band->words *
+		sizeof(uint64_t));
+	wordCounts = (size_t*) malloc(haloSize(link) * sizeof(size_t));
+	if(words == NULL || wordCounts == NULL){
+		printf("%s", "error allocating output");
+		exit(1);
+	}
+	for(row = 0; row < band->rows; row++){
+		packRow(band->current,row,words + (size_t) row * band->words,
+			band->words);
+	}
+	for(rank = 0; rank < haloSize(link); rank++){
+		partitionBand(haloSize(link),rows,rank,&beg,&end);
+		wordCounts[rank] = (size_t) (end - beg + 1) * band->words;
+	}
+	if(haloRank(link) == 0){
+		cp = initializeCheckpoint(rows,band->cols,wrap);
+		cp->generation = generation;
+		cp->liveCount = counts[0];
+		cp->totalLiveCount = counts[1];
+	}
+	gatherToRoot(link,words,(size_t) band->rows * band->words,
+		cp != NULL ? cp->bits : NULL,wordCounts);
+	free(words);
+	free(wordCounts);
+	if(cp == NULL){
+		return;
+	}
+	outFile = fopen(fileName, "w");
+	if(outFile == NULL){
+		printf("%s", "Error opening output file.");
+		exit(1);
+	}
+	failed = writeRleFile(outFile,cp) != 0;
+	failed = fclose(outFile) != 0 || failed;
+	freeCheckpoint(cp);
+	if(failed){
+		printf("%s", "error writing output file");
+		exit(1);
+	}
+}
+
+/**
+ * Main. Reads the board, starts the ranks, runs every rank's band and
+ * prints the summed live counts and the run time on rank 0.
+ * @param argc: amount of arguments in argv
+ * @param argv: array of command line arguments
+ * @return 0
+ * @throws exit(1) if the arguments or the file are invalid
+ */
+int main(int argc, char* argv[]){
+	simOptions opts;
+	fileOptions fopts;
+	boardFile board;
+	rankBand band;
+	simdRowFunc simdRow;
+	haloLink* link;
+	struct timeval start_time, end_time;
+	const char* error;
+	const char* outputFile = NULL;
+	FILE* inFile;
+	long long counts[2];
+	long long ready = 0;
+	int numRanks, wrap, rank, beg, end;
+	int i;
+	double runTime;
+
+	if(argc < 4){
+		printf("%s", "Not enough command line arguments");
+		exit(1);
+	}
+	numRanks = atoi(argv[2]);
+	if(numRanks < 1){
+		printf("%s", "invalid number of processes");
+		exit(1);
+	}
+	if(strcmp(argv[3],"wrap") != 0 && strcmp(argv[3],"nowrap") != 0){
+		printf("%s", "invalid wrap argument");
+		exit(1);
+	}
+	wrap = strcmp(argv[3],"wrap") == 0;
+	defaultSimOptions(&opts);
+	defaultFileOptions(&fopts);
+	for(i = 4; i < argc; i++){
+		if(parseFileOption(&fopts,argv[i],&error)){
+			if(error != NULL){
+				printf("%s", error);
+				exit(1);
+			}
+			continue;
+		}
+		if(strncmp(argv[i],"--output=",9) == 0 && argv[i][9] != '\0'){
+			outputFile = argv[i]+9;
+			continue;
+		}
+		//only the simd kernel runs a band
+		error = strncmp(argv[i],"--simd=",7) == 0 ?
+			parseSimOption(&opts,argv[i]) : "invalid option";
+		if(error != NULL){
+			printf("%s", error);
+			exit(1);
+		}
+	}
+	inFile = fopen(argv[1], "r");
+	if(inFile == NULL){
+		printf("%s", "Error opening file.");
+		exit(1);
+	}
+	error = readBoardFile(inFile,&board,&fopts,1);
+	if(error != NULL){
+		printf("%s", error);
+		exit(1);
+	}
+	fclose(inFile);
+	if(numRanks > board.rows){
+		printf("%s", "more processes than rows");
+		exit(1);
+	}
+	simdRow = pickSimdKernel(opts.simdIsa);
+	if(simdRow == NULL){
+		printf("%s", "simd instruction set not supported");
+		exit(1);
+	}
+
+	//the ranks forked here get the board already read
+	link = openHaloLinks(&argc,&argv,numRanks);
+	rank = haloRank(link);
+	partitionBand(numRanks,board.rows,rank,&beg,&end);
+	counts[0] = loadBand(&band,&board,beg,end,wrap);
+	counts[1] = 0;
+	band.simdRow = simdRow;
+	freeBoardFile(&board);
+	sumOverRanks(link,&ready,1); //every rank starts together
+
+	gettimeofday(&start_time, 0); //get start time
+	for(i = 0; i < board.iterations; i++){
+		counts[0] = stepBand(&band,link,wrap);
+		counts[1] += counts[0];
+	}
+	sumOverRanks(link,counts,2);
+	gettimeofday(&end_time, 0); //get end time
+	if(outputFile != NULL){
+		writeOutput(&band,link,board.rows,board.iterations,wrap,counts,
+			outputFile);
+	}
+
+	if(rank == 0){
+		printf("Simd instruction set: %s\n\n",simdKernelName(simdRow));
+		for(i = 0; i < numRanks; i++){
+			partitionBand(numRanks,board.rows,i,&beg,&end);
+			printf("Rank %d: Rows: %d:%d (%d)\n", i, beg, end,
+				end - beg + 1);
+		}
+		printf("\nThere are %lld live cells in this board.\n", counts[0]);
+		printf("There were a total of %lld live cells during the "
+			"simulation.\n\n", counts[1]);
+		runTime = (end_time.tv_sec - start_time.tv_sec) +
+			(end_time.tv_usec - start_time.tv_usec) / 1000000.0;
+		printf("Total time for %d iterations of %dx%d on %d processes is "
+			"%0.6f secs\n", board.iterations, board.rows, board.cols,
+			numRanks, runTime);
+		printf("%0.0f cell updates/sec\n\n", runTime > 0 ?
+			(double) board.rows * board.cols * board.iterations / runTime :
+			0.0);
+		fflush(stdout);
+	}
+	freeBoard(band.current);
+	freeBoard(band.next);
+	free(band.top);
+	if(closeHaloLinks(link) > 0){
+		printf("%s", "error in a rank process");
+		exit(1);
+	}
+	return 0;
+}
@@ -0,0 +1,698 @@
+//halo.c
+//Description: Links between the ranks of a distributed run. The rank above
+//             and below are found the same way by both transports; the MPI
+//             one posts nonblocking sends and receives for the halo, the
+//             socket one hands them to a thread that moves all four edge
+//             rows with poll until every byte is through. Sums and the
+//             final board go through rank 0.
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include "halo.h"
+#ifdef USE_MPI
+#include <mpi.h>
+#else
+#include <unistd.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <errno.h>
+#include <pthread.h>
+#include <sys/types.h>
+#include <sys/socket.h>
+#include <sys/wait.h>
+#endif
+
+#define TAG_DOWN 0 // Message of a rank's last row, to the rank below
+#define TAG_UP 1 // Message of a rank's first row, to the rank above
+#define TAG_GATHER 2 // Message of a rank's rows, to rank 0
+#define GATHER_CHUNK ((size_t) 1 << 24) // Most words of one gather message
+
+#ifdef USE_MPI
+
+struct haloLink{
+	int rank; // Rank of this process
+	int size; // Number of ranks
+	MPI_Request requests[4]; // Sends and receives of the exchange
+	int numRequests; // Number of requests posted
+};
+
+#else
+
+typedef struct haloJob{
+	const uint64_t* top; // First row of the band, sent up
+	const uint64_t* bottom; // Last row of the band, sent down
+	uint64_t* above; // Gets the last row of the rank above
+	uint64_t* below; // Gets the first row of the rank below
+	size_t words; // Words of each row
+	int hasAbove; // 1 if there is a rank above
+	int hasBelow; // 1 if there is a rank below
+} haloJob;
+
+struct haloLink{
+	int rank; // Rank of this process
+	int size; // Number of ranks
+	int up; // Socket to the rank above, -1 if none
+	int down; // Socket to the rank below, -1 if none
+	int root; // Socket to rank 0, -1 on rank 0
+	int* ranks; // Socket to each other rank on rank 0, else NULL
+	pid_t* pids; // Process of each other rank on rank 0, else NULL
+	pthread_t thread; // Thread moving the halo
+	pthread_mutex_t lock; // Protects job, pending, quit and failed
+	pthread_cond_t changed; // Signaled when pending or quit change
+	haloJob job; // Exchange to run
+	int pending; // 1 from the start of an exchange until it is done
+	int quit; // Set to end the thread
+	int failed; // Set if a neighbor could not be reached
+};
+
+#endif
+
+/**
+ * Works out which neighbors a rank exchanges rows with
+ * @param rank: the rank
+ * @param size: the number of ranks
+ * @param wrap: 0 for nowrap 1 for wrap
+ * @param up: set to the rank above, -1 if none
+ * @param down: set to the rank below, -1 if none
+ * @return nothing
+ */
+static void neighborRanks(int rank, int size, int wrap, int* up, int* down){
+	*up = rank > 0 ? rank - 1 : (wrap ? size - 1 : -1);
+	*down = rank < size - 1 ? rank + 1 : (wrap ? 0 : -1);
+}
+
+/**
+ * Fills the halo rows that do not come from another rank: dead past the
+ * edges of a board that does not wrap, and a single rank's own edges when
+ * it wraps
+ * @param link: the links
+ * @param top: the first row of the band
+ * @param bottom: the last row of the band
+ * @param above: gets the row above the band
+ * @param below: gets the row below the band
+ * @param words: words of each row
+ * @param wrap: 0 for nowrap 1 for wrap
+ * @return: 1 if rows are left for the other ranks to send, 0 otherwise
+ */
+static int localHalo(const haloLink* link, const uint64_t* top,
+	const uint64_t* bottom, uint64_t* above, uint64_t* below, size_t words,
+	int wrap){
+	int up, down;
+
+	neighborRanks(link->rank,link->size,wrap,&up,&down);
+	if(link->size == 1 && wrap){
+		memcpy(above, bottom, words * sizeof(uint64_t));
+		memcpy(below, top, words * sizeof(uint64_t));
+		return 0;
+	}
+	if(up < 0){
+		memset(above, 0, words * sizeof(uint64_t));
+	}
+	if(down < 0){
+		memset(below, 0, words * sizeof(uint64_t));
+	}
+	return up >= 0 || down >= 0;
+}
+
+#ifdef USE_MPI
+
+/**
+ * Starts MPI and checks that mpirun started the number of ranks asked for
+ * @param argc: pointer to the number of command line arguments
+ * @param argv: pointer to the command line arguments
+ * @param numRanks: the number of ranks asked for
+ * @return: the links of this rank
+ * @throws exit(1) if the links can not be allocated or mpirun started
+ *                 another number of ranks
+ */
+haloLink* openHaloLinks(int* argc, char*** argv, int numRanks){
+	haloLink* link;
+
+	link = (haloLink*) malloc(sizeof(haloLink));
+	if(link == NULL){
+		printf("%s", "error allocating links");
+		exit(1);
+	}
+	MPI_Init(argc, argv);
+	MPI_Comm_rank(MPI_COMM_WORLD, &link->rank);
+	MPI_Comm_size(MPI_COMM_WORLD, &link->size);
+	link->numRequests = 0;
+	if(link->size != numRanks){
+		if(link->rank == 0){
+			printf("%s", "number of processes does not match mpirun");
+		}
+		MPI_Finalize();
+		exit(1);
+	}
+	return link;
+}
+
+/**
+ * Posts the receives of the halo rows and the sends of the edge rows
+ * @param link: the links
+ * @param top: the first row of the band, not changed until finished
+ * @param bottom: the last row of the band, not changed until finished
+ * @param above: gets the last row of the rank above
+ * @param below: gets the first row of the rank below
+ * @param words: words of each row
+ * @param wrap: 0 for nowrap 1 for wrap
+ * @return nothing
+ */
+void startHaloExchange(haloLink* link, const uint64_t* top,
+	const uint64_t* bottom, uint64_t* above, uint64_t* below, size_t words,
+	int wrap){
+	int up, down;
+
+	link->numRequests = 0;
+	if(!localHalo(link,top,bottom,above,below,words,wrap)){
+		return;
+	}
+	neighborRanks(link->rank,link->size,wrap,&up,&down);
+	if(up >= 0){
+		MPI_Irecv(above, (int) words, MPI_UINT64_T, up, TAG_DOWN,
+			MPI_COMM_WORLD, &link->requests[link->numRequests++]);
+		MPI_Isend(top, (int) words, MPI_UINT64_T, up, TAG_UP,
+			MPI_COMM_WORLD, &link->requests[link->numRequests++]);
+	}
+	if(down >= 0){
+		MPI_Irecv(below, (int) words, MPI_UINT64_T, down, TAG_UP,
+			MPI_COMM_WORLD, &link->requests[link->numRequests++]);
+		MPI_Isend(bottom, (int) words, MPI_UINT64_T, down, TAG_DOWN,
+			MPI_COMM_WORLD, &link->requests[link->numRequests++]);
+	}
+}
+
+/**
+ * Waits until the halo rows arrived and the edge rows were sent
+ * @param link: the links
+ * @return nothing
+ */
+void finishHaloExchange(haloLink* link){
+	MPI_Waitall(link->numRequests, link->requests, MPI_STATUSES_IGNORE);
+	link->numRequests = 0;
+}
+
+/**
+ * Sums values over every rank, each rank gets the sums
+ * @param link: the links, unused
+ * @param values: this rank's values, replaced by the sums
+ * @param count: the number of values
+ * @return nothing
+ */
+void sumOverRanks(haloLink* link, long long* values, int count){
+	(void) link;
+	MPI_Allreduce(MPI_IN_PLACE, values, count, MPI_LONG_LONG, MPI_SUM,
+		MPI_COMM_WORLD);
+}
+
+/**
+ * Collects every rank's words on rank 0, in the order of the ranks
+ * @param link: the links
+ * @param words: this rank's words
+ * @param count: the number of words of this rank
+ * @param all: gets every rank's words on rank 0, unused on the others
+ * @param counts: the number of words of each rank, used on rank 0
+ * @return nothing
+ */
+void gatherToRoot(haloLink* link, const uint64_t* words, size_t count,
+	uint64_t* all, const size_t* counts){
+	size_t sent, chunk;
+	int rank;
+
+	if(link->rank != 0){
+		for(sent = 0; sent < count; sent += chunk){
+			chunk = count - sent < GATHER_CHUNK ? count - sent :
+				GATHER_CHUNK;
+			MPI_Send(words + sent, (int) chunk, MPI_UINT64_T, 0, TAG_GATHER,
+				MPI_COMM_WORLD);
+		}
+		return;
+	}
+	memcpy(all, words, count * sizeof(uint64_t));
+	all += count;
+	for(rank = 1; rank < link->size; rank++){
+		for(sent = 0; sent < counts[rank]; sent += chunk){
+			chunk = counts[rank] - sent < GATHER_CHUNK ?
+				counts[rank] - sent : GATHER_CHUNK;
+			MPI_Recv(all + sent, (int) chunk, MPI_UINT64_T, rank, TAG_GATHER,
+				MPI_COMM_WORLD, MPI_STATUS_IGNORE);
+		}
+		all += counts[rank];
+	}
+}
+
+/**
+ * Ends MPI and frees the links
+ * @param link: the links
+ * @return: 0, a rank that fails ends the whole run
+ */
+int closeHaloLinks(haloLink* link){
+	MPI_Finalize();
+	free(link);
+	return 0;
+}
+
+#else
+
+/**
+ * Writes every byte of a buffer to a blocking socket
+ * @param fd: the socket
+ * @param buffer: the bytes
+ * @param bytes: the number of bytes
+ * @return nothing
+ * @throws exit(1) if the other rank can not be reached
+ */
+static void writeAll(int fd, const void* buffer, size_t bytes){
+	const char* pos = (const char*) buffer;
+	ssize_t done;
+
+	while(bytes > 0){
+		done = write(fd, pos, bytes);
+		if(done < 0 && errno == EINTR){
+			continue;
+		}
+		if(done <= 0){
+			printf("%s", "error exchanging with ranks");
+			exit(1);
+		}
+		pos += done;
+		bytes -= done;
+	}
+}
+
+/**
+ * Reads a number of bytes from a blocking socket
+ * @param fd: the socket
+ * @param buffer: gets the bytes
+ * @param bytes: the number of bytes
+ * @return nothing
+ * @throws exit(1) if the other rank can not be reached
+ */
+static void readAll(int fd, void* buffer, size_t bytes){
+	char* pos = (char*) buffer;
+	ssize_t done;
+
+	while(bytes > 0){
+		done = read(fd, pos, bytes);
+		if(done < 0 && errno == EINTR){
+			continue;
+		}
+		if(done <= 0){
+			printf("%s", "error exchanging with ranks");
+			exit(1);
+		}
+		pos += done;
+		bytes -= done;
+	}
+}
+
+/**
+ * Moves the rows of an exchange over the nonblocking sockets to the
+ * neighbors, sending and receiving at the same time so two ranks sending
+ * rows bigger than the socket buffers to each other do not wait on each
+ * other
+ * @param link: the links
+ * @param job: the exchange
+ * @return: 0 on success, -1 if a neighbor can not be reached
+ */
+static int moveHalo(haloLink* link, const haloJob* job){
+	struct pollfd polls[4];
+	char* buffers[4];
+	size_t left[4];
+	int fds[4];
+	int sends[4];
+	int numMoves = 0;
+	int numPolls;
+	int i;
+	ssize_t done;
+
+	if(job->hasAbove){
+		fds[numMoves] = link->up;
+		buffers[numMoves] = (char*) job->top;
+		sends[numMoves++] = 1;
+		fds[numMoves] = link->up;
+		buffers[numMoves] = (char*) job->above;
+		sends[numMoves++] = 0;
+	}
+	if(job->hasBelow){
+		fds[numMoves] = link->down;
+		buffers[numMoves] = (char*) job->bottom;
+		sends[numMoves++] = 1;
+		fds[numMoves] = link->down;
+		buffers[numMoves] = (char*) job->below;
+		sends[numMoves++] = 0;
+	}
+	for(i = 0; i < numMoves; i++){
+		left[i] = job->words * sizeof(uint64_t);
+	}
+	while(1){
+		numPolls = 0;
+		for(i = 0; i < numMoves; i++){
+			if(left[i] > 0){
+				polls[numPolls].fd = fds[i];
+				polls[numPolls].events = sends[i] ? POLLOUT : POLLIN;
+				polls[numPolls].revents = 0;
+				numPolls++;
+			}
+		}
+		if(numPolls == 0){
+			return 0;
+		}
+		if(poll(polls, numPolls, -1) < 0){
+			if(errno == EINTR){
+				continue;
+			}
+			return -1;
+		}
+		for(i = 0; i < numMoves; i++){
+			if(left[i] == 0){
+				continue;
+			}
+			if(sends[i]){
+				done = write(fds[i], buffers[i], left[i]);
+			}
+			else{
+				done = read(fds[i], buffers[i], left[i]);
+			}
+			if(done < 0 && (errno == EAGAIN || errno == EWOULDBLOCK ||
+				errno == EINTR)){
+				continue;
+			}
+			if(done <= 0){
+				return -1;
+			}
+			buffers[i] += done;
+			left[i] -= done;
+		}
+	}
+}
+
+/**
+ * Driver function of the halo thread. Runs each exchange it is handed
+ * until it is told to quit.
+ * @param arguments: pointer to the haloLink
+ * @return NULL
+ */
+static void* runHaloThread(void* arguments){
+	haloLink* link = (haloLink*) arguments;
+	haloJob job;
+	int failed;
+
+	pthread_mutex_lock(&link->lock);
+	while(1){
+		while(!link->pending && !link->quit){
+			pthread_cond_wait(&link->changed, &link->lock);
+		}
+		if(link->quit){
+			break;
+		}
+		job = link->job;
+		pthread_mutex_unlock(&link->lock);
+		failed = moveHalo(link,&job) != 0;
+		pthread_mutex_lock(&link->lock);
+		link->failed |= failed;
+		link->pending = 0;
+		pthread_cond_signal(&link->changed);
+	}
+	pthread_mutex_unlock(&link->lock);
+	return NULL;
+}
+
+/**
+ * Forks the other ranks of a run on this machine and links them. Each rank
+ * is joined to the rank below it by a socket pair, the last one to rank 0,
+ * and rank 0 to every other rank for the sums and the final board.
+ * @param argc: pointer to the number of command line arguments, unused
+ * @param argv: pointer to the command line arguments, unused
+ * @param numRanks: the number of ranks
+ * @return: the links of the rank the calling process became
+ * @throws exit(1) if the links can not be created
+ */
+haloLink* openHaloLinks(int* argc, char*** argv, int numRanks){
+	haloLink* link;
+	int* ring; // ring[2i] is rank i's end of the pair to rank i+1
+	int* control; // control[2i] is rank 0's end of the pair to rank i
+	int keep[3];
+	int i, j, k;
+	pid_t pid;
+
+	(void) argc;
+	(void) argv;
+	link = (haloLink*) malloc(sizeof(haloLink));
+	ring = (int*) malloc(2 * numRanks * sizeof(int));
+	control = (int*) malloc(2 * numRanks * sizeof(int));
+	if(link == NULL || ring == NULL || control == NULL){
+		printf("%s", "error allocating links");
+		exit(1);
+	}
+	memset(link, 0, sizeof(haloLink));
+	link->size = numRanks;
+	link->up = -1;
+	link->down = -1;
+	link->root = -1;
+	for(i = 0; i < numRanks && numRanks > 1; i++){
+		if(socketpair(AF_UNIX, SOCK_STREAM, 0, ring + 2 * i) != 0 ||
+			(i > 0 && socketpair(AF_UNIX, SOCK_STREAM, 0,
+			control + 2 * i) != 0)){
+			printf("%s", "error creating links");
+			exit(1);
+		}
+	}
+	link->ranks = (int*) malloc(numRanks * sizeof(int));
+	link->pids = (pid_t*) malloc(numRanks * sizeof(pid_t));
+	if(link->ranks == NULL || link->pids == NULL){
+		printf("%s", "error allocating links");
+		exit(1);
+	}
+	//the children must not write out what rank 0 buffered
+	fflush(stdout);
+	for(i = 1; i < numRanks; i++){
+		pid = fork();
+		if(pid < 0){
+			printf("%s", "error creating processes");
+			exit(1);
+		}
+		if(pid == 0){
+			link->rank = i;
+			break;
+		}
+		link->pids[i] = pid;
+	}
+	if(numRanks > 1){
+		i = link->rank;
+		link->up = ring[2 * ((i + numRanks - 1) % numRanks) + 1];
+		link->down = ring[2 * i];
+		if(i > 0){
+			link->root = control[2 * i + 1];
+		}
+		keep[0] = link->up;
+		keep[1] = link->down;
+		keep[2] = link->root;
+		for(j = 0; j < 2 * numRanks; j++){
+			for(k = 0; k < 3 && keep[k] != ring[j]; k++);
+			if(k == 3){
+				close(ring[j]);
+			}
+			if(j < 2){
+				continue;
+			}
+			if(i == 0 && j % 2 == 0){
+				link->ranks[j / 2] = control[j];
+			}
+			else if(control[j] != link->root){
+				close(control[j]);
+			}
+		}
+		fcntl(link->up, F_SETFL, fcntl(link->up, F_GETFL) | O_NONBLOCK);
+		fcntl(link->down, F_SETFL, fcntl(link->down, F_GETFL) | O_NONBLOCK);
+	}
+	if(link->rank > 0){
+		free(link->ranks);
+		free(link->pids);
+		link->ranks = NULL;
+		link->pids = NULL;
+	}
+	free(ring);
+	free(control);
+	pthread_mutex_init(&link->lock, NULL);
+	pthread_cond_init(&link->changed, NULL);
+	if(pthread_create(&link->thread,NULL,runHaloThread,link) != 0){
+		printf("%s", "error creating threads");
+		exit(1);
+	}
+	return link;
+}
+
+/**
+ * Hands the exchange of the halo rows to the halo thread and returns
+ * @param link: the links
+ * @param top: the first row of the band, not changed until finished
+ * @param bottom: the last row of the band, not changed until finished
+ * @param above: gets the last row of the rank above
+ * @param below: gets the first row of the rank below
+ * @param words: words of each row
+ * @param wrap: 0 for nowrap 1 for wrap
+ * @return nothing
+ */
+void startHaloExchange(haloLink* link, const uint64_t* top,
+	const uint64_t* bottom, uint64_t* above, uint64_t* below, size_t words,
+	int wrap){
+	int up, down;
+
+	if(!localHalo(link,top,bottom,above,below,words,wrap)){
+		return;
+	}
+	neighborRanks(link->rank,link->size,wrap,&up,&down);
+	pthread_mutex_lock(&link->lock);
+	link->job.top = top;
+	link->job.bottom = bottom;
+	link->job.above = above;
+	link->job.below = below;
+	link->job.words = words;
+	link->job.hasAbove = up >= 0;
+	link->job.hasBelow = down >= 0;
+	link->pending = 1;
+	pthread_cond_signal(&link->changed);
+	pthread_mutex_unlock(&link->lock);
+}
+
+/**
+ * Waits until the halo thread moved every row of the exchange
+ * @param link: the links
+ * @return nothing
+ * @throws exit(1) if a neighbor could not be reached
+ */
+void finishHaloExchange(haloLink* link){
+	int failed;
+
+	pthread_mutex_lock(&link->lock);
+	while(link->pending){
+		pthread_cond_wait(&link->changed, &link->lock);
+	}
+	failed = link->failed;
+	pthread_mutex_unlock(&link->lock);
+	if(failed){
+		printf("%s", "error exchanging halo");
+		exit(1);
+	}
+}
+
+/**
+ * Sums values over every rank, each rank gets the sums. The other ranks
+ * send theirs to rank 0, which sends the sums back.
+ * @param link: the links
+ * @param values: this rank's values, replaced by the sums
+ * @param count: the number of values
+ * @return nothing
+ * @throws exit(1) if a rank can not be reached
+ */
+void sumOverRanks(haloLink* link, long long* values, int count){
+	long long* theirs;
+	int rank, i;
+
+	if(link->rank != 0){
+		writeAll(link->root, values, count * sizeof(long long));
+		readAll(link->root, values, count * sizeof(long long));
+		return;
+	}
+	theirs = (long long*) malloc(count * sizeof(long long));
+	if(theirs == NULL){
+		printf("%s", "error allocating sums");
+		exit(1);
+	}
+	for(rank = 1; rank < link->size; rank++){
+		readAll(link->ranks[rank], theirs, count * sizeof(long long));
+		for(i = 0; i < count; i++){
+			values[i] += theirs[i];
+		}
+	}
+	for(rank = 1; rank < link->size; rank++){
+		writeAll(link->ranks[rank], values, count * sizeof(long long));
+	}
+	free(theirs);
+}
+
+/**
+ * Collects every rank's words on rank 0, in the order of the ranks
+ * @param link: the links
+ * @param words: this rank's words
+ * @param count: the number of words of this rank
+ * @param all: gets every rank's words on rank 0, unused on the others
+ * @param counts: the number of words of each rank, used on rank 0
+ * @return nothing
+ * @throws exit(1) if a rank can not be reached
+ */
+void gatherToRoot(haloLink* link, const uint64_t* words, size_t count,
+	uint64_t* all, const size_t* counts){
+	int rank;
+
+	if(link->rank != 0){
+		writeAll(link->root, words, count * sizeof(uint64_t));
+		return;
+	}
+	memcpy(all, words, count * sizeof(uint64_t));
+	all += count;
+	for(rank = 1; rank < link->size; rank++){
+		readAll(link->ranks[rank], all, counts[rank] * sizeof(uint64_t));
+		all += counts[rank];
+	}
+}
+
+/**
+ * Ends the halo thread and closes the links. Rank 0 then waits for the
+ * other ranks to exit.
+ * @param link: the links
+ * @return: the number of other ranks that failed, 0 on the other ranks
+ */
+int closeHaloLinks(haloLink* link){
+	int failures = 0;
+	int status;
+	int rank;
+
+	pthread_mutex_lock(&link->lock);
+	link->quit = 1;
+	pthread_cond_signal(&link->changed);
+	pthread_mutex_unlock(&link->lock);
+	pthread_join(link->thread,NULL);
+	pthread_mutex_destroy(&link->lock);
+	pthread_cond_destroy(&link->changed);
+	if(link->size > 1){
+		close(link->up);
+		close(link->down);
+	}
+	if(link->root >= 0){
+		close(link->root);
+	}
+	for(rank = 1; link->rank == 0 && rank < link->size; rank++){
+		close(link->ranks[rank]);
+		if(waitpid(link->pids[rank], &status, 0) < 0 ||
+			!WIFEXITED(status) || WEXITSTATUS(status) != 0){
+			failures++;
+		}
+	}
+	free(link->ranks);
+	free(link->pids);
+	free(link);
+	return failures;
+}
+
+#endif
+
+/**
+ * Returns the rank of this process
+ * @param link: the links
+ * @return: the rank, 0 to haloSize-1
+ */
+int haloRank(const haloLink* link){
+	return link->rank;
+}
+
+/**
+ * Returns the number of ranks of the run
+ * @param link: the links
+ * @return: the number of ranks
+ */
+int haloSize(const haloLink* link){
+	return link->size;
+}
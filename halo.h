@@ -0,0 +1,43 @@
+//halo.h
+//Description: Links between the processes (ranks) of a distributed run,
+//             each of which owns a band of rows of the board. Every
+//             generation a rank sends its first row to the rank above and
+//             its last row to the rank below and receives their edge rows
+//             for its halo. The exchange is started before the rows that do
+//             not need the halo are calculated and finished after, so it
+//             overlaps them. Rank 0 is above the last rank when the board
+//             wraps. Rows travel bit-packed, 64 cells per word.
+//             Built with -DUSE_MPI (mpicc) the ranks are the processes of
+//             mpirun and the links are nonblocking MPI messages. Otherwise
+//             the first process forks the other ranks on the same machine
+//             and they are linked by Unix-domain socket pairs, with a thread
+//             per rank moving the halo while the rank calculates.
+
+#ifndef HALO_H
+#define HALO_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+typedef struct haloLink haloLink;
+
+haloLink* openHaloLinks(int* argc, char*** argv, int numRanks);
+
+int haloRank(const haloLink* link);
+
+int haloSize(const haloLink* link);
+
+void startHaloExchange(haloLink* link, const uint64_t* top,
+	const uint64_t* bottom, uint64_t* above, uint64_t* below, size_t words,
+	int wrap);
+
+void finishHaloExchange(haloLink* link);
+
+void sumOverRanks(haloLink* link, long long* values, int count);
+
+void gatherToRoot(haloLink* link, const uint64_t* words, size_t count,
+	uint64_t* all, const size_t* counts);
+
+int closeHaloLinks(haloLink* link);
+
+#endif /* HALO_H */
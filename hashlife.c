@@ -0,0 +1,806 @@
+//hashlife.c
+//Description: Hashlife engine. Every node of the quadtree is unique (hash
+//             consed on its four children), so equal regions of the board
+//             and of its history share their memoized results. A node of
+//             level k covers 2^k x 2^k cells and memoizes its center, of
+//             level k-1, 2^s generations later with s = min(stepLog, k-2).
+//             Each node also memoizes the sum of the populations of that
+//             center over those generations so the total live count of a run
+//             comes out exactly without visiting every generation.
+//             Leaves are dead, alive or void. Void cells never change and
+//             never count as neighbors, which makes them the edge of a
+//             bounded board.
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <stdint.h>
+#include "hashlife.h"
+
+#define HL_DEAD 0
+#define HL_ALIVE 1
+#define HL_VOID 2
+#define HL_MAX_LEVEL 64
+#define HL_TABLE_SIZE (1 << 16) // Initial number of hash buckets
+#define HL_GC_NODES (1 << 22) // Node count that triggers a collection
+#define HL_TORUS_STEP 19 // Largest step that may grow the torus copies
+
+typedef struct hlNode{
+	struct hlNode* nw; // Children, NULL for leaves
+	struct hlNode* ne;
+	struct hlNode* sw;
+	struct hlNode* se;
+	struct hlNode* result; // Memoized center after 2^resultStep generations
+	struct hlNode* next; // Next node in the hash bucket
+	long long population; // Number of alive cells
+	long long popSum; // Population of the center summed over the result
+	int level; // The node covers 2^level x 2^level cells
+	int state; // HL_DEAD, HL_ALIVE or HL_VOID for leaves
+	int resultStep; // Log2 of the generations of result, -1 for none
+	int mark; // Set while collecting garbage
+} hlNode;
+
+struct hashlife{
+	int rows; // Number of rows in the grid
+	int cols; // Number of columns in the grid
+	int wrap; // 0 for nowrap 1 for wrap
+	int stepLog; // Log2 of the generations of the current step
+	long long tiles; // Copies of the torus in root (wrap), 1 otherwise
+	hlNode* root; // Grid at [0,0], surrounded by void or torus copies
+	hlNode leaves[3]; // The dead, alive and void leaf
+	hlNode* empty[HL_MAX_LEVEL]; // All dead node of each level
+	hlNode* voids[HL_MAX_LEVEL]; // All void node of each level
+	hlNode** table; // Hash buckets of all nodes above the leaves
+	size_t tableSize; // Number of buckets, a power of two
+	size_t nodeCount; // Number of nodes in the table
+	size_t gcLimit; // Node count that triggers the next collection
+	int* cells; // Row, column pairs added before the tree is built
+	size_t cellCount; // Number of pairs in cells
+	size_t cellCap; // Number of pairs cells can hold
+};
+
+/**
+ * Hashes the four children of a node
+ * @param nw,ne,sw,se: the children
+ * @return: the hash value
+ */
+static size_t hashChildren(const hlNode* nw, const hlNode* ne,
+	const hlNode* sw, const hlNode* se){
+	uint64_t h = (uintptr_t) nw;
+
+	h = h * 0x9e3779b97f4a7c15ULL + (uintptr_t) ne;
+	h = h * 0x9e3779b97f4a7c15ULL + (uintptr_t) sw;
+	h = h * 0x9e3779b97f4a7c15ULL + (uintptr_t) se;
+	return (size_t) (h ^ (h >> 29));
+}
+
+/**
+ * Doubles the number of hash buckets and moves every node to its new bucket
+ * @param hl: the engine
+ * @return nothing
+ * @throws exit(1) if the table can not be allocated
+ */
+static void growTable(hashlife* hl){
+	size_t newSize = hl->tableSize * 2;
+	hlNode** newTable;
+	hlNode* n;
+	hlNode* next;
+	size_t i;
+	size_t h;
+
+	newTable = (hlNode**) calloc(newSize, sizeof(hlNode*));
+	if(newTable == NULL){
+		printf("%s", "error allocating hashlife table");
+		exit(1);
+	}
+	for(i = 0; i < hl->tableSize; i++){
+		for(n = hl->table[i]; n != NULL; n = next){
+			next = n->next;
+			h = hashChildren(n->nw,n->ne,n->sw,n->se) & (newSize - 1);
+			n->next = newTable[h];
+			newTable[h] = n;
+		}
+	}
+	free(hl->table);
+	hl->table = newTable;
+	hl->tableSize = newSize;
+}
+
+/**
+ * Returns the unique node with the given children, creating it if needed
+ * @param hl: the engine
+ * @param nw,ne,sw,se: the children, all of the same level
+ * @return: the node one level above the children
+ * @throws exit(1) if the node can not be allocated
+ */
+static hlNode* join(hashlife* hl, hlNode* nw, hlNode* ne, hlNode* sw,
+	hlNode* se){
+	size_t h = hashChildren(nw,ne,sw,se) & (hl->tableSize - 1);
+	hlNode* n;
+
+	for(n = hl->table[h]; n != NULL; n = n->next){
+		if(n->nw == nw && n->ne == ne && n->sw == sw && n->se == se){
+			return n;
+		}
+	}
+	n = (hlNode*) malloc(sizeof(hlNode));
+	if(n == NULL){
+		printf("%s", "error allocating hashlife node");
+		exit(1);
+	}
+	n->nw = nw;
+	n->ne = ne;
+	n->sw = sw;
+	n->se = se;
+	n->result = NULL;
+	n->population = nw->population + ne->population + sw->population +
+		se->population;
+	n->popSum = 0;
+	n->level = nw->level + 1;
+	n->state = HL_DEAD;
+	n->resultStep = -1;
+	n->mark = 0;
+	n->next = hl->table[h];
+	hl->table[h] = n;
+	hl->nodeCount++;
+	if(hl->nodeCount > hl->tableSize){
+		growTable(hl);
+	}
+	return n;
+}
+
+/**
+ * Returns the node of a level whose cells are all dead
+ * @param hl: the engine
+ * @param level: the level of the node
+ * @return: the empty node
+ */
+static hlNode* emptyNode(hashlife* hl, int level){
+	hlNode* e;
+
+	if(level == 0){
+		return &hl->leaves[HL_DEAD];
+	}
+	if(hl->empty[level] == NULL){
+		e = emptyNode(hl,level-1);
+		hl->empty[level] = join(hl,e,e,e,e);
+	}
+	return hl->empty[level];
+}
+
+/**
+ * Returns the node of a level whose cells are all void
+ * @param hl: the engine
+ * @param level: the level of the node
+ * @return: the void node
+ */
+static hlNode* voidNode(hashlife* hl, int level){
+	hlNode* v;
+
+	if(level == 0){
+		return &hl->leaves[HL_VOID];
+	}
+	if(hl->voids[level] == NULL){
+		v = voidNode(hl,level-1);
+		hl->voids[level] = join(hl,v,v,v,v);
+	}
+	return hl->voids[level];
+}
+
+/**
+ * Returns the center of a node without advancing it
+ * @param hl: the engine
+ * @param n: a node of level 2 or more
+ * @return: the center node, one level below n
+ */
+static hlNode* centerNode(hashlife* hl, hlNode* n){
+	return join(hl,n->nw->se,n->ne->sw,n->sw->ne,n->se->nw);
+}
+
+/**
+ * Fills sub with the nine overlapping nodes one level below n, spaced a
+ * quarter of n apart
+ * @param hl: the engine
+ * @param n: a node of level 2 or more
+ * @param sub: the 3 x 3 nodes, row by row
+ * @return nothing
+ */
+static void subSquares(hashlife* hl, hlNode* n, hlNode* sub[3][3]){
+	sub[0][0] = n->nw;
+	sub[0][1] = join(hl,n->nw->ne,n->ne->nw,n->nw->se,n->ne->sw);
+	sub[0][2] = n->ne;
+	sub[1][0] = join(hl,n->nw->sw,n->nw->se,n->sw->nw,n->sw->ne);
+	sub[1][1] = centerNode(hl,n);
+	sub[1][2] = join(hl,n->ne->sw,n->ne->se,n->se->nw,n->se->ne);
+	sub[2][0] = n->sw;
+	sub[2][1] = join(hl,n->sw->ne,n->se->nw,n->sw->se,n->se->sw);
+	sub[2][2] = n->se;
+}
+
+/**
+ * Returns the next state of cell [r,c] of a 4 x 4 block of leaf states
+ * @param g: the block
+ * @param r: row of the cell, 1 or 2
+ * @param c: column of the cell, 1 or 2
+ * @return: the state of the cell one generation later
+ */
+static int nextLeafState(int g[4][4], int r, int c){
+	int i;
+	int j;
+	int liveNeighbors = 0;
+
+	if(g[r][c] == HL_VOID){
+		return HL_VOID;
+	}
+	for(i = r-1; i <= r+1; i++){
+		for(j = c-1; j <= c+1; j++){
+			if((i != r || j != c) && g[i][j] == HL_ALIVE){
+				liveNeighbors++;
+			}
+		}
+	}
+	if(liveNeighbors == 3 || (liveNeighbors == 2 && g[r][c] == HL_ALIVE)){
+		return HL_ALIVE;
+	}
+	return HL_DEAD;
+}
+
+/**
+ * Advances a level 2 node by one generation
+ * @param hl: the engine
+ * @param n: the level 2 node
+ * @return: its level 1 center one generation later
+ */
+static hlNode* baseResult(hashlife* hl, hlNode* n){
+	hlNode* quads[2][2];
+	int g[4][4];
+	int i;
+	int j;
+
+	quads[0][0] = n->nw;
+	quads[0][1] = n->ne;
+	quads[1][0] = n->sw;
+	quads[1][1] = n->se;
+	for(i = 0; i < 2; i++){
+		for(j = 0; j < 2; j++){
+			g[2*i][2*j] = quads[i][j]->nw->state;
+			g[2*i][2*j+1] = quads[i][j]->ne->state;
+			g[2*i+1][2*j] = quads[i][j]->sw->state;
+			g[2*i+1][2*j+1] = quads[i][j]->se->state;
+		}
+	}
+	return join(hl,&hl->leaves[nextLeafState(g,1,1)],
+		&hl->leaves[nextLeafState(g,1,2)],&hl->leaves[nextLeafState(g,2,1)],
+		&hl->leaves[nextLeafState(g,2,2)]);
+}
+
+/**
+ * Returns the center of a node 2^s generations later, s = min(stepLog,
+ * level-2), and memoizes it together with the population of the center
+ * summed over those generations (popSum).
+ * When s is level-2 the nine sub-squares are advanced half way and the
+ * four nodes built from their results advanced the other half. The
+ * population of the center during the first half comes from four nodes
+ * built from the unadvanced centers of the sub-squares, whose centers tile
+ * the center of n. When s is smaller only the second half advances.
+ * @param hl: the engine
+ * @param n: a node of level 2 or more
+ * @return: the advanced center, one level below n
+ */
+static hlNode* nodeResult(hashlife* hl, hlNode* n){
+	int step = hl->stepLog < n->level-2 ? hl->stepLog : n->level-2;
+	hlNode* sub[3][3];
+	hlNode* centers[3][3];
+	hlNode* half[3][3];
+	hlNode* quad[2][2];
+	hlNode* before;
+	hlNode* after;
+	long long popSum = 0;
+	int i;
+	int j;
+
+	if(n->resultStep == step){
+		return n->result;
+	}
+	if(n->population == 0){
+		//nothing can be born, the center stays as it is
+		n->result = centerNode(hl,n);
+	}
+	else if(n->level == 2){
+		n->result = baseResult(hl,n);
+		popSum = n->result->population;
+	}
+	else{
+		subSquares(hl,n,sub);
+		for(i = 0; i < 3; i++){
+			for(j = 0; j < 3; j++){
+				centers[i][j] = centerNode(hl,sub[i][j]);
+				if(step == n->level-2){
+					half[i][j] = nodeResult(hl,sub[i][j]);
+				}
+				else{
+					half[i][j] = centers[i][j];
+				}
+			}
+		}
+		for(i = 0; i < 2; i++){
+			for(j = 0; j < 2; j++){
+				after = join(hl,half[i][j],half[i][j+1],half[i+1][j],
+					half[i+1][j+1]);
+				quad[i][j] = nodeResult(hl,after);
+				popSum += after->popSum;
+				if(step == n->level-2){
+					before = join(hl,centers[i][j],centers[i][j+1],
+						centers[i+1][j],centers[i+1][j+1]);
+					nodeResult(hl,before);
+					popSum += before->popSum;
+				}
+			}
+		}
+		n->result = join(hl,quad[0][0],quad[0][1],quad[1][0],quad[1][1]);
+	}
+	n->popSum = popSum;
+	n->resultStep = step;
+	return n->result;
+}
+
+/**
+ * Marks a node and everything below it as reachable
+ * @param n: the node
+ * @return nothing
+ */
+static void markNode(hlNode* n){
+	if(n == NULL || n->mark){
+		return;
+	}
+	n->mark = 1;
+	if(n->level > 0){
+		markNode(n->nw);
+		markNode(n->ne);
+		markNode(n->sw);
+		markNode(n->se);
+	}
+}
+
+/**
+ * Frees every node that can not be reached from the root. Memoized results
+ * pointing at freed nodes are forgotten.
+ * @param hl: the engine
+ * @return nothing
+ */
+static void collectGarbage(hashlife* hl){
+	hlNode** link;
+	hlNode* n;
+	size_t i;
+	int level;
+
+	markNode(hl->root);
+	for(level = 0; level < HL_MAX_LEVEL; level++){
+		markNode(hl->empty[level]);
+		markNode(hl->voids[level]);
+	}
+	for(i = 0; i < hl->tableSize; i++){
+		for(n = hl->table[i]; n != NULL; n = n->next){
+			if(n->mark && n->result != NULL && !n->result->mark){
+				n->result = NULL;
+				n->resultStep = -1;
+			}
+		}
+	}
+	for(i = 0; i < hl->tableSize; i++){
+		link = &hl->table[i];
+		while(*link != NULL){
+			n = *link;
+			if(n->mark){
+				n->mark = 0;
+				link = &n->next;
+			}
+			else{
+				*link = n->next;
+				free(n);
+				hl->nodeCount--;
+			}
+		}
+	}
+	hl->gcLimit = hl->nodeCount * 2 > HL_GC_NODES ?
+		hl->nodeCount * 2 : HL_GC_NODES;
+}
+
+/**
+ * Creates a Hashlife engine for a board of size row x col
+ * @param row: the number of rows in the grid
+ * @param col: the number of columns in the grid
+ * @param wrap: 0 for nowrap 1 for wrap
+ * @return: the engine, or NULL if wrap is set and row or col is not a power
+ *          of two
+ * @throws exit(1) if the engine can not be allocated
+ */
+hashlife* initializeHashlife(int row, int col, int wrap){
+	hashlife* hl;
+	int i;
+
+	if(wrap && ((row & (row - 1)) != 0 || (col & (col - 1)) != 0)){
+		return NULL;
+	}
+	hl = (hashlife*) calloc(1, sizeof(hashlife));
+	if(hl == NULL){
+		printf("%s", "error allocating hashlife");
+		exit(1);
+	}
+	hl->rows = row;
+	hl->cols = col;
+	hl->wrap = wrap;
+	hl->tiles = 1;
+	for(i = 0; i < 3; i++){
+		hl->leaves[i].state = i;
+		hl->leaves[i].population = i == HL_ALIVE;
+		hl->leaves[i].resultStep = -1;
+	}
+	hl->tableSize = HL_TABLE_SIZE;
+	hl->table = (hlNode**) calloc(hl->tableSize, sizeof(hlNode*));
+	if(hl->table == NULL){
+		printf("%s", "error allocating hashlife table");
+		exit(1);
+	}
+	hl->gcLimit = HL_GC_NODES;
+	return hl;
+}
+
+/**
+ * Frees the engine and all of its nodes
+ * @param hl: the engine, may be NULL
+ * @return nothing
+ */
+void freeHashlife(hashlife* hl){
+	hlNode* n;
+	hlNode* next;
+	size_t i;
+
+	if(hl == NULL){
+		return;
+	}
+	for(i = 0; i < hl->tableSize; i++){
+		for(n = hl->table[i]; n != NULL; n = next){
+			next = n->next;
+			free(n);
+		}
+	}
+	free(hl->table);
+	free(hl->cells);
+	free(hl);
+}
+
+/**
+ * Records a live cell of the initial board. The tree is built from all the
+ * recorded cells by buildHashlife.
+ * @param hl: the engine
+ * @param row: row of the live cell
+ * @param col: column of the live cell
+ * @return nothing
+ * @throws exit(1) if the cell is outside of the board
+ */
+void addHashlifeCell(hashlife* hl, int row, int col){
+	if(row < 0 || row >= hl->rows || col < 0 || col >= hl->cols){
+		printf("%s", "live cell outside of the board");
+		exit(1);
+	}
+	if(hl->cellCount == hl->cellCap){
+		hl->cellCap = hl->cellCap == 0 ? 1024 : hl->cellCap * 2;
+		hl->cells = (int*) realloc(hl->cells, hl->cellCap * 2 * sizeof(int));
+		if(hl->cells == NULL){
+			printf("%s", "error allocating hashlife cells");
+			exit(1);
+		}
+	}
+	hl->cells[2*hl->cellCount] = row;
+	hl->cells[2*hl->cellCount+1] = col;
+	hl->cellCount++;
+}
+
+/**
+ * Moves the pairs whose row (axis 0) or column (axis 1) is below limit to
+ * the front of the list
+ * @param cells: the row, column pairs
+ * @param count: the number of pairs
+ * @param axis: 0 to compare rows, 1 to compare columns
+ * @param limit: the row or column to split at
+ * @return: the number of pairs below limit
+ */
+static size_t partitionCells(int* cells, size_t count, int axis,
+	long long limit){
+	size_t low = 0;
+	size_t i;
+	int swap;
+
+	for(i = 0; i < count; i++){
+		if(cells[2*i+axis] < limit){
+			swap = cells[2*i];
+			cells[2*i] = cells[2*low];
+			cells[2*low] = swap;
+			swap = cells[2*i+1];
+			cells[2*i+1] = cells[2*low+1];
+			cells[2*low+1] = swap;
+			low++;
+		}
+	}
+	return low;
+}
+
+/**
+ * Builds the node covering the 2^level x 2^level cells at [y,x] of a
+ * bounded board; cells outside of the grid are void
+ * @param hl: the engine
+ * @param level: the level of the node
+ * @param y: first row covered by the node
+ * @param x: first column covered by the node
+ * @param cells: the live cells inside the node, reordered while building
+ * @param count: the number of live cells
+ * @return: the node
+ */
+static hlNode* buildRegion(hashlife* hl, int level, long long y, long long x,
+	int* cells, size_t count){
+	long long size = 1LL << level;
+	long long half = size / 2;
+	size_t top;
+	size_t topLeft;
+	size_t bottomLeft;
+
+	if(y >= hl->rows || x >= hl->cols){
+		return voidNode(hl,level);
+	}
+	if(count == 0 && y + size <= hl->rows && x + size <= hl->cols){
+		return emptyNode(hl,level);
+	}
+	if(level == 0){
+		return &hl->leaves[HL_ALIVE];
+	}
+	top = partitionCells(cells,count,0,y + half);
+	topLeft = partitionCells(cells,top,1,x + half);
+	bottomLeft = partitionCells(cells + 2*top,count - top,1,x + half);
+	return join(hl,
+		buildRegion(hl,level-1,y,x,cells,topLeft),
+		buildRegion(hl,level-1,y,x + half,cells + 2*topLeft,top - topLeft),
+		buildRegion(hl,level-1,y + half,x,cells + 2*top,bottomLeft),
+		buildRegion(hl,level-1,y + half,x + half,cells + 2*(top + bottomLeft),
+			count - top - bottomLeft));
+}
+
+/**
+ * Returns the node of a level at [y,x] inside another node
+ * @param n: the node to look in
+ * @param level: the level of the wanted node
+ * @param y: its first row, relative to n
+ * @param x: its first column, relative to n
+ * @return: the node
+ */
+static hlNode* nodeAt(hlNode* n, int level, long long y, long long x){
+	long long half;
+
+	while(n->level > level){
+		half = 1LL << (n->level - 1);
+		if(y < half){
+			n = x < half ? n->nw : n->ne;
+		}
+		else{
+			n = x < half ? n->sw : n->se;
+			y -= half;
+		}
+		if(x >= half){
+			x -= half;
+		}
+	}
+	return n;
+}
+
+/**
+ * Builds the square node of a level that tiles a torus made of blocks laid
+ * out side by side (across) or on top of each other. The node is the same
+ * down the other direction, so it only depends on its offset.
+ * @param hl: the engine
+ * @param blocks: the square blocks of the torus
+ * @param blockLevel: the level of the blocks
+ * @param level: the level of the node
+ * @param offset: first column (across) or row of the node in the torus
+ * @param across: 1 if the blocks are side by side
+ * @return: the node
+ */
+static hlNode* tileTorus(hashlife* hl, hlNode** blocks, int blockLevel,
+	int level, long long offset, int across){
+	hlNode* first;
+	hlNode* second;
+
+	if(level == blockLevel){
+		return blocks[offset >> blockLevel];
+	}
+	first = tileTorus(hl,blocks,blockLevel,level-1,offset,across);
+	second = tileTorus(hl,blocks,blockLevel,level-1,
+		offset + (1LL << (level-1)),across);
+	if(across){
+		return join(hl,first,second,first,second);
+	}
+	return join(hl,first,first,second,second);
+}
+
+/**
+ * Returns the smallest level whose nodes cover size cells across
+ * @param size: number of cells
+ * @return: the level
+ */
+static int levelFor(long long size){
+	int level = 0;
+
+	while((1LL << level) < size){
+		level++;
+	}
+	return level;
+}
+
+/**
+ * Builds the tree from the live cells recorded with addHashlifeCell. A
+ * bounded board is placed at [0,0] of a void universe. A torus is tiled
+ * into a square so the root is periodic with the torus' period.
+ * @param hl: the engine
+ * @return nothing
+ */
+void buildHashlife(hashlife* hl){
+	int level = levelFor(hl->rows > hl->cols ? hl->rows : hl->cols);
+	int blockLevel;
+	long long numBlocks;
+	long long i;
+	hlNode* rect;
+	hlNode** blocks;
+
+	rect = buildRegion(hl,level,0,0,hl->cells,hl->cellCount);
+	if(!hl->wrap){
+		hl->root = rect;
+	}
+	else{
+		//square blocks of the short side, laid along the long side
+		blockLevel = levelFor(hl->rows < hl->cols ? hl->rows : hl->cols);
+		numBlocks = 1LL << (level - blockLevel);
+		blocks = (hlNode**) malloc(numBlocks * sizeof(hlNode*));
+		if(blocks == NULL){
+			printf("%s", "error allocating hashlife blocks");
+			exit(1);
+		}
+		for(i = 0; i < numBlocks; i++){
+			if(hl->rows <= hl->cols){
+				blocks[i] = nodeAt(rect,blockLevel,0,i << blockLevel);
+			}
+			else{
+				blocks[i] = nodeAt(rect,blockLevel,i << blockLevel,0);
+			}
+		}
+		hl->root = tileTorus(hl,blocks,blockLevel,level,0,
+			hl->rows <= hl->cols);
+		hl->tiles = numBlocks;
+		free(blocks);
+	}
+	free(hl->cells);
+	hl->cells = NULL;
+	hl->cellCount = 0;
+	hl->cellCap = 0;
+}
+
+/**
+ * Doubles the size of the root, keeping the grid at [0,0]. Bounded boards
+ * get more void, a torus gets more copies of itself.
+ * @param hl: the engine
+ * @return nothing
+ */
+static void growRoot(hashlife* hl){
+	hlNode* v;
+
+	if(hl->wrap){
+		hl->root = join(hl,hl->root,hl->root,hl->root,hl->root);
+		hl->tiles *= 4;
+	}
+	else{
+		v = voidNode(hl,hl->root->level);
+		hl->root = join(hl,hl->root,v,v,v);
+	}
+}
+
+/**
+ * Advances the board by 2^stepLog generations
+ * @param hl: the engine
+ * @param stepLog: log2 of the number of generations
+ * @return: the number of live cells of the board summed over each of the
+ *          generations advanced
+ */
+long long stepHashlife(hashlife* hl, int stepLog){
+	hlNode* outer;
+	hlNode* v;
+	hlNode* r;
+	long long popSum;
+
+	if(hl->wrap && stepLog > HL_TORUS_STEP && hl->root->level - 1 < stepLog){
+		//more copies would overflow the summed populations, take two halves
+		popSum = stepHashlife(hl,stepLog-1);
+		return popSum + stepHashlife(hl,stepLog-1);
+	}
+	while(hl->root->level < 2 || hl->root->level - 1 < stepLog){
+		growRoot(hl);
+	}
+	hl->stepLog = stepLog;
+	if(hl->wrap){
+		//the center of a 2 x 2 tiling is the torus shifted by half
+		outer = join(hl,hl->root,hl->root,hl->root,hl->root);
+		r = nodeResult(hl,outer);
+		hl->root = join(hl,r->se,r->sw,r->ne,r->nw);
+		popSum = outer->popSum / hl->tiles;
+	}
+	else{
+		v = voidNode(hl,hl->root->level-1);
+		outer = join(hl,
+			join(hl,v,v,v,hl->root->nw),join(hl,v,v,hl->root->ne,v),
+			join(hl,v,hl->root->sw,v,v),join(hl,hl->root->se,v,v,v));
+		hl->root = nodeResult(hl,outer);
+		popSum = outer->popSum;
+	}
+	if(hl->nodeCount > hl->gcLimit){
+		collectGarbage(hl);
+	}
+	return popSum;
+}
+
+/**
+ * Returns the largest step (as a log2) that does not go past a number of
+ * generations
+ * @param generations: the number of generations left, at least 1
+ * @return: the largest s with 2^s <= generations
+ */
+int maxHashlifeStep(int generations){
+	int stepLog = 0;
+
+	while(stepLog < 30 && (1 << (stepLog + 1)) <= generations){
+		stepLog++;
+	}
+	return stepLog;
+}
+
+/**
+ * Returns the number of live cells of the board
+ * @param hl: the engine
+ * @return: the number of live cells
+ */
+long long hashlifePopulation(const hashlife* hl){
+	return hl->root->population / hl->tiles;
+}
+
+/**
+ * Returns the state of the cell at [row,col]
+ * @param hl: the engine
+ * @param row: row of the cell
+ * @param col: column of the cell
+ * @return: 1 if the cell is alive, 0 if it is dead
+ */
+int getHashlifeCell(const hashlife* hl, int row, int col){
+	return nodeAt(hl->root,0,row,col)->state == HL_ALIVE;
+}
+
+/**
+ * Prints the board on screen in the same format as displayBoard
+ * @param hl: the engine
+ * @return nothing
+ * @throws exit(1) if the row buffer can not be allocated
+ */
+void displayHashlife(const hashlife* hl){
+	char* line;
+	int i;
+	int j;
+
+	line = (char*) malloc(hl->cols + 1);
+	if(line == NULL){
+		printf("%s", "error allocating board");
+		exit(1);
+	}
+	//build each row in a buffer and print it with one call
+	for(i = 0; i < hl->rows; i++){
+		for(j = 0; j < hl->cols; j++){
+			line[j] = getHashlifeCell(hl,i,j) == 0 ? '-' : '@';
+		}
+		line[hl->cols] = '\n';
+		fwrite(line, 1, hl->cols + 1, stdout);
+	}
+	free(line);
+}
@@ -0,0 +1,33 @@
+//hashlife.h
+//Description: Hashlife engine. The board is kept as a hash-consed quadtree
+//             whose nodes memoize their center 2^k generations ahead, so
+//             sparse or repetitive patterns can be advanced by huge numbers
+//             of generations at once. Bounded boards (nowrap) surround the
+//             grid with permanently dead "void" cells; a torus (wrap) needs
+//             power of two rows and columns and is advanced as a periodic
+//             tiling of itself.
+
+#ifndef HASHLIFE_H
+#define HASHLIFE_H
+
+typedef struct hashlife hashlife;
+
+hashlife* initializeHashlife(int row, int col, int wrap);
+
+void freeHashlife(hashlife* hl);
+
+void addHashlifeCell(hashlife* hl, int row, int col);
+
+void buildHashlife(hashlife* hl);
+
+long long stepHashlife(hashlife* hl, int stepLog);
+
+int maxHashlifeStep(int generations);
+
+long long hashlifePopulation(const hashlife* hl);
+
+int getHashlifeCell(const hashlife* hl, int row, int col);
+
+void displayHashlife(const hashlife* hl);
+
+#endif /* HASHLIFE_H */
@@ -0,0 +1,142 @@
+//lut.c
+//Description: Lookup-table step kernel for the board. A 4x4 block of cells
+//             is a 16 bit index whose bit 4j+i is the cell of row i, column
+//             j of the block, so each column of the block is a nibble and
+//             moving the block two columns to the right is a shift by 8
+//             bits and two new nibbles. The halo of the board holds the
+//             neighbors past the edges for both wrap and nowrap; cells of a
+//             block below the region's last row or right of its last column
+//             are left out of the index and their results are not written.
+
+#include <stdint.h>
+#include <pthread.h>
+#include "board.h"
+#include "lut.h"
+
+static uint8_t lifeTable[1 << 16]; // Next 2x2 block of every 4x4 block
+
+static pthread_once_t tableOnce = PTHREAD_ONCE_INIT; // Builds lifeTable once
+
+/**
+ * Fills lifeTable by applying the rule to the four middle cells of every
+ * 4x4 block. Bits 0 and 1 of an entry are the top row of the 2x2 block,
+ * bits 2 and 3 its bottom row.
+ * @return nothing
+ */
+static void buildLifeTable(void){
+	int index;
+	int row, col, i, j;
+	int sum;
+	uint8_t next;
+
+	for(index = 0; index < 1 << 16; index++){
+		next = 0;
+		for(row = 1; row <= 2; row++){
+			for(col = 1; col <= 2; col++){
+				sum = 0;
+				for(i = row - 1; i <= row + 1; i++){
+					for(j = col - 1; j <= col + 1; j++){
+						if(i != row || j != col){
+							sum += index >> (4 * j + i) & 1;
+						}
+					}
+				}
+				if(sum == 3 || (sum == 2 && (index >> (4 * col + row) & 1))){
+					next |= 1 << (2 * (row - 1) + col - 1);
+				}
+			}
+		}
+		lifeTable[index] = next;
+	}
+}
+
+/**
+ * Builds the table of the kernel, once however many simulators call it
+ * @return nothing
+ */
+void initializeLutKernel(void){
+	pthread_once(&tableOnce, buildLifeTable);
+}
+
+/**
+ * Reads a column of a 4x4 block
+ * @param up: the row above the block's middle rows
+ * @param mid: the top middle row
+ * @param down: the bottom middle row
+ * @param under: the row below the middle rows
+ * @param col: the column
+ * @param mask: 0xf, or 0x7 to leave the row below dead
+ * @return: the column as a nibble, bit i the cell of row i of the block
+ */
+static inline int blockColumn(const cell* up, const cell* mid,
+	const cell* down, const cell* under, int col, int mask){
+	return (up[col] | mid[col] << 1 | down[col] << 2 | under[col] << 3) &
+		mask;
+}
+
+/**
+ * Calculates the next iteration of a region of the board two rows at a time
+ * with one table lookup per 2x2 block of cells. A last row without a pair
+ * is calculated on its own.
+ * @param currentBoard: the board for the current iteration
+ * @param nextBoard: the board for the next iteration
+ * @param begRow: The start row for the thread
+ * @param begCol: The start col for the thread
+ * @param endCol: One past the end col for the thread
+ * @param endRow: One past the end row for the thread
+ * @return: the number of live cells in the calculated part of nextBoard
+ */
+int calcNextLutIteration(cellBoard* currentBoard, cellBoard* nextBoard,
+	int begRow, int begCol, int endCol, int endRow){
+	const cell* up;
+	const cell* mid;
+	const cell* down;
+	const cell* under;
+	cell* out;
+	cell* outBelow;
+	int row, col;
+	int pair, mask;
+	int index, next;
+	int liveCells = 0;
+
+	for(row = begRow; row < endRow; row += 2){
+		pair = row + 1 < endRow;
+		up = ROW(currentBoard,row-1);
+		mid = ROW(currentBoard,row);
+		down = ROW(currentBoard,row+1);
+		//without a pair the row below the region stays in the halo
+		under = pair ? ROW(currentBoard,row+2) : down;
+		out = ROW(nextBoard,row);
+		outBelow = ROW(nextBoard,pair ? row+1 : row);
+		mask = pair ? 0xf : 0x7;
+		index = blockColumn(up,mid,down,under,begCol-1,mask) |
+			blockColumn(up,mid,down,under,begCol,mask) << 4;
+		for(col = begCol; col + 1 < endCol; col += 2){
+			index |= blockColumn(up,mid,down,under,col+1,mask) << 8 |
+				blockColumn(up,mid,down,under,col+2,mask) << 12;
+			next = lifeTable[index];
+			out[col] = next & 1;
+			out[col+1] = next >> 1 & 1;
+			if(pair){
+				outBelow[col] = next >> 2 & 1;
+				outBelow[col+1] = next >> 3;
+			}
+			else{
+				next &= 0x3;
+			}
+			liveCells += __builtin_popcount(next);
+			index >>= 8;
+		}
+		if(col < endCol){
+			//the column right of the region is left dead
+			index |= blockColumn(up,mid,down,under,col+1,mask) << 8;
+			next = lifeTable[index] & (pair ? 0x5 : 0x1);
+			out[col] = next & 1;
+			if(pair){
+				outBelow[col] = next >> 2;
+			}
+			liveCells += __builtin_popcount(next);
+		}
+	}
+	return liveCells;
+}
@@ -0,0 +1,19 @@
+//lut.h
+//Description: Lookup-table step kernel for the board. The next state of a
+//             2x2 block of cells only depends on the 4x4 block around it, so
+//             a table of the next 2x2 block of every one of the 65536 4x4
+//             blocks, built once, gives four cells per lookup. The kernel
+//             calculates two rows at a time, sliding the 4x4 block two
+//             columns per lookup.
+
+#ifndef LUT_H
+#define LUT_H
+
+#include "board.h"
+
+void initializeLutKernel(void);
+
+int calcNextLutIteration(cellBoard* currentBoard, cellBoard* nextBoard,
+	int begRow, int begCol, int endCol, int endRow);
+
+#endif /* LUT_H */
@@ -3,77 +3,113 @@
 //Description: This program simulates a multithreaded Conway's Game of Life
 //             using input from the user. The user will input a filename, 
 //             number of threads, row or col for row partitioning or col 
-//             partitioning respectfully, a wrap or no wrap argument, a hide 
-//             argument, a show argument, and a speed argument 
+//             partitioning respectfully (or tile for tiles handed out each
+//             generation with work stealing), a wrap or no wrap argument, a
+//             hide argument, a show argument, and a speed argument 
 //             (only if show == "show").
 //             In the input file the first line will have the # of rows, the
 //             second line will have the # of columns, and the third line will
 //             have the # of iterations to run the simulation. Every subsequent
 //             line will be a pair of row, column positions to set to live in
-//             the initial state.
+//             the initial state. RLE, Life 1.06 and plaintext (.cells)
+//             patterns are read too, see --format below.
+//             Optional arguments may follow the positional ones:
+//             --kernel=scalar|bitpack|simd|lut|rolling selects the step
+//             kernel, bitpack stores the boards as 64 cells per word, simd
+//             computes a row segment per vector instruction, lut a 2x2 block
+//             of cells per lookup in a table of every 4x4 block, rolling
+//             keeps three-row column sums as it walks down the rows.
+//             --simd=auto|avx512|avx2|sse2|scalar forces the instruction set
+//             of the simd kernel instead of picking it with CPUID.
+//             --engine=sweep|hashlife selects the threaded sweep or the
+//             Hashlife engine, which advances 2^k generations at a time.
+//             --tile=N sets the rows and columns of cells per tile of the
+//             active region (default 32), only tiles near a change are
+//             recalculated. 0 recalculates every cell every generation.
+//             --depth=K lets each thread advance K generations between
+//             barriers on a private copy of its band and a K cell deep halo
+//             (row and col partitions of the byte grid, hide only).
+//             --barrier=spin|pthread selects the barrier between
+//             generations, spin waits briefly before sleeping on a futex.
+//             Threads meet at one barrier per generation. With a row or col
+//             partition they meet at none: each thread only waits until the
+//             threads next to its band finished the generation before.
+//             --format=auto|pairs|rle|life106|cells gives the format of the
+//             input file instead of detecting it. A pattern has no number of
+//             iterations, give it with --iterations=N (which also overrides
+//             the iterations of a file of pairs). --board=RxC runs a pattern
+//             centered on an R row, C column board instead of one of the
+//             pattern's size. --output=name writes the final board to name
+//             as RLE.
+//             --frames=dir writes every generation to dir as a PBM image
+//             and --record=name every generation to name as RLE, in hide
+//             mode too. The frames of show and of these outputs go through
+//             a ring of --ring=N copies (default 16) to a thread of their
+//             own; when it falls behind the run waits for it, or with
+//             --drop-frames drops the oldest frame and goes on.
+//             --checkpoint=N writes a checkpoint of the board every N
+//             generations to the file of --checkpoint-file=name (default
+//             checkpoint.gol), on a thread of its own. --resume=name loads
+//             such a checkpoint instead of the input file's cells and runs
+//             the generations left up to the file's number of iterations.
+//             --numa pins the threads node by node and has each one clear
+//             the rows it calculates, so they are placed on its node.
+//             --profile times every thread's calculation, barrier waits
+//             and waits for its neighbors and prints them with the
+//             partition. --trace=name also writes every such phase to name
+//             as a Chrome trace (chrome://tracing or Perfetto).
+//             --cycles[=N] stops calculating once the board repeats one of
+//             the last N generations (default 64) and extrapolates the rest
+//             of the run from the period, which is printed with the counts.
+//             The simulation is run by the simulator library (simulator.h),
+//             which keeps its worker threads between runs; this file only
+//             reads the arguments and the input file and prints the results.
+
 
 #include <stdlib.h>
 #include <stdio.h>
 #include <unistd.h>
 #include <string.h>
 #include <sys/time.h>
-#include <pthread.h>
-#include "pthread_barrier.h"
-
-pthread_barrier_t threadBarrier; // Global barrier
-
-int currentLiveCount = 0; //Global iteration live count
-
-int totalLiveCount = 0; //Global total live count
-
-pthread_mutex_t m;
-
-typedef struct threadArg{
-	int maxRow; // End row of board
-	int maxCol; // End col of board 
-	int begCol; // Beginning col of board for thread
-	int begRow; // Beginning row of board for thread
-	int endCol; // End col of board for thread
-	int endRow; // End row of board for thread
-	int iterations; // Number of iterations
-	int showSpeed; // speed argument
-	int wrap; // wrap argument
-	int threadNum;
-	int numThreads;
-	int** currentBoard; // Pointer to current board
-	int** nextBoard; // Pointer to next board
-} threadArg;
+#include "simulator.h"
+#include "boardfile.h"
+#include "simd.h"
+#include "checkpoint.h"
+#include "output.h"
+
+#define CHECKPOINT_FILE "checkpoint.gol" // Default file of the checkpoints
+
+typedef struct runOptions{
+	int checkpointEvery; // Generations between checkpoints, 0 for none
+	const char* checkpointFile; // File the checkpoints are written to
+	const char* resumeFile; // Checkpoint to resume from, NULL for none
+	const char* outputFile; // RLE file of the final board, NULL for none
+	const char* traceFile; // Chrome trace of the threads, NULL for none
+} runOptions;
 
 void verifyCommandArg(char** argv, int argc,FILE* inFile);
 
-int getSizeIterations(int* row, int*col, FILE* inFile);
-
-void GetBoardStateFromFile(int** board, FILE* inFile);
-
-int** initializeBoard(int row, int col);
+void getOptions(int argc, char** argv, simOptions* opts, fileOptions* fopts,
+	outputOptions* oopts, runOptions* run);
 
-void displayBoard(int** board, int row, int col);
-
-int checkNeighbors(int** board, int curRow, int curCol, 
-	int rowMax, int colMax, int wrap);
+int getShowType(char *argv[]);
 
-void calcNextIteration(int** currentBoard, int** nextBoard,int row,int col,
-	int begRow, int begCol,int endCol,int endRow,int wrap);
+void loadBoard(simulator* sim, boardFile* board, runOptions* run, int wrap);
 
-int getShowType(char *argv[]);
+void writeOutput(simulator* sim, const char* fileName);
 
-void partition(int numThreads, int row, int col, char* partType, 
-	threadArg* threadInput);
+void runShow(simulator* sim, int iterations, int every,
+	checkpointWriter* writer, frameQueue* frames);
 
-threadArg* initializeThreadInput(int numThreads, int iterations,int row,
-	int col,char* wrap, int show, int** currentBoard, int** nextBoard);
+void printStartupTime(struct timeval* load_time,
+	struct timeval* start_time, int numCells);
 
-void* runSlice(void* arguments);
+void printRunTime(struct timeval* start_time, struct timeval* end_time,
+	int iterations, int row, int col);
 
-void printFinal(int** currentBoard, int maxRow, int maxCol);
+void printLiveCounts(simulator* sim);
 
-void freeMem(int** currentBoard, int** nextBoard,threadArg* threadInput,
-		pthread_t* threadID,int row);
+void printTileCounts(simulator* sim, int iterations);
 
 /**
  * Main. Calls the functions to run the simulation in the appropriate order
@@ -84,80 +120,124 @@ void freeMem(int** currentBoard, int** nextBoard,threadArg* threadInput,
  * @throws exit(1) if file entered by user is invalid
  */
 int main(int argc, char* argv[]){
-	int** currentBoard;
-	int** nextBoard; 
-	int row,col,iterations,i,j;
-	struct timeval start_time, end_time;
-	float runTime;
+	simulator* sim;
+	simOptions opts;
+	fileOptions fopts;
+	outputOptions oopts;
+	runOptions run;
+	boardFile board;
+	checkpointWriter* writer = NULL;
+	frameQueue* frames = NULL;
+	const char* error;
+	struct timeval load_time, start_time, end_time;
 	FILE* inFile;
-	struct threadArg* threadInput;
-	pthread_t* threadID;
+	int startGeneration;
+	int downsampled = 0;
 
+	gettimeofday(&load_time, 0); //get time before reading the file
 	inFile = fopen(argv[1], "r");
 	verifyCommandArg(argv,argc,inFile);
+	getOptions(argc,argv,&opts,&fopts,&oopts,&run);
+	if(checkSimOptions(&opts) != NULL){
+		printf("%s", checkSimOptions(&opts));
+		exit(1);
+	}
 
-	iterations = getSizeIterations(&row,&col,inFile);
-	currentBoard = initializeBoard(row,col);
-	nextBoard = initializeBoard(row,col);
 	//get starting board state
-	GetBoardStateFromFile(currentBoard,inFile);
+	error = readBoardFile(inFile,&board,&fopts,opts.numThreads);
+	if(error != NULL){
+		printf("%s", error);
+		exit(1);
+	}
 	fclose(inFile);
-
-	threadInput = initializeThreadInput(atoi(argv[2]),iterations,
-		row,col,argv[4],getShowType(argv),currentBoard,nextBoard);
-
-	partition(atoi(argv[2]),row,col,argv[3],threadInput);
-
-	pthread_barrier_init (&threadBarrier,NULL,atoi(argv[2]));
-	pthread_mutex_init(&m, NULL);
-
-	threadID = (pthread_t*) malloc(atoi(argv[2])* sizeof(pthread_t));
+	sim = createSimulator(&opts);
+	loadBoard(sim,&board,&run,opts.wrap);
+	freeBoardFile(&board);
+	startGeneration = simulatorGeneration(sim);
+	if(run.checkpointEvery > 0){
+		writer = startCheckpointWriter(run.checkpointFile);
+	}
 
 	gettimeofday(&start_time, 0); //get start time
-
-	for(i=0;i<atoi(argv[2]);i++){
-		pthread_create(&threadID[i],NULL,runSlice,&threadInput[i]);
+	system("clear");
+	if(outputWanted(&oopts)){
+		frames = startFrameQueue(&oopts,board.rows,board.cols);
 	}
-
-	for(i=0;i<atoi(argv[2]);i++){
-		pthread_join(threadID[i],NULL);
+	runShow(sim,board.iterations,run.checkpointEvery,writer,frames);
+	if(frames != NULL){
+		downsampled = frames->screen != NULL && frames->screen->braille;
+		if(stopFrameQueue(frames) > 0){
+			printf("%s", "error writing frames");
+			exit(1);
+		}
+	}
+	if(!oopts.screen || downsampled){
+		//display final grid, show already drew it unless it was braille
+		displaySimulator(sim);
 	}
+	printLiveCounts(sim);
+	if(simulatorTileCount(sim) > 0){
+		printTileCounts(sim,simulatorGeneration(sim) - startGeneration);
+	}
+	printSimulatorThreads(sim);
 	gettimeofday(&end_time, 0); //get end time
-	
-	//calculate run time
-	runTime = (end_time.tv_sec - start_time.tv_sec) + 
-			  ((end_time.tv_usec - start_time.tv_usec))/1000000.0;
-
-	printf("\nTotal time for %d iterations of %dx%d is %0.6f secs\n\n",
-		iterations,row,col,runTime);
-	freeMem(currentBoard, nextBoard,threadInput,threadID,row);
+	if(run.outputFile != NULL){
+		writeOutput(sim,run.outputFile);
+	}
+	printStartupTime(&load_time,&start_time,board.numCells);
+	printRunTime(&start_time,&end_time,board.iterations,board.rows,
+		board.cols);
+	if(run.traceFile != NULL && writeSimulatorTrace(sim,run.traceFile) != 0){
+		printf("%s", simulatorError(sim));
+		exit(1);
+	}
+	destroySimulator(sim);
+	if(writer != NULL && stopCheckpointWriter(writer) > 0){
+		printf("%s", "error writing checkpoint");
+		exit(1);
+	}
 
 	return 0;
 }
 
 /**
- * Frees the allocated memory for each malloc
- * @param currentBoard: pointer to the grid for the current iteration
- * @param nextBoard: pointer to the grid for the next iteration
- * @param threadInput: The array of thread inputs
- * @param threadID: The array of thread ids
+ * Calculates and prints the time spent before the simulation started,
+ * reading the input file and setting up the board
+ * @param load_time: time the program started reading the file
+ * @param start_time: time the simulation started
+ * @param numCells: Number of live cells read from the file
+ * @return nothing
+ */
+void printStartupTime(struct timeval* load_time,
+	struct timeval* start_time, int numCells){
+	float startupTime;
+
+	startupTime = (start_time->tv_sec - load_time->tv_sec) +
+		((start_time->tv_usec - load_time->tv_usec))/1000000.0;
+
+	printf("\nStartup time for %d live cells is %0.6f secs\n",
+		numCells,startupTime);
+}
+
+/**
+ * Calculates and prints the run time of the simulation
+ * @param start_time: time the simulation started
+ * @param end_time: time the simulation ended
+ * @param iterations: Number of iterations that were run
  * @param row: The number of rows in the grid
+ * @param col: The number of columns in the grid
  * @return nothing
  */
-void freeMem(int** currentBoard, int** nextBoard,threadArg* threadInput,
-		pthread_t* threadID,int row){
-	int i;
+void printRunTime(struct timeval* start_time, struct timeval* end_time,
+	int iterations, int row, int col){
+	float runTime;
 
-	//Free the memory allocated for the grids
-	for(i = 0; i < row; i++){
-		free(currentBoard[i]);
-		free(nextBoard[i]);
-	}
-	free(currentBoard);
-	free(nextBoard);
-	free(threadInput);
-	free(threadID);
+	//calculate run time
+	runTime = (end_time->tv_sec - start_time->tv_sec) + 
+			  ((end_time->tv_usec - start_time->tv_usec))/1000000.0;
 
+	printf("\nTotal time for %d iterations of %dx%d is %0.6f secs\n\n",
+		iterations,row,col,runTime);
 }
 
 /**
@@ -203,7 +283,8 @@ void verifyCommandArg(char** argv, int argc,FILE* inFile){
 		exit(1);
 	}
 
-	if(strcmp(argv[3],"row") != 0 && strcmp(argv[3],"col") != 0){
+	if(strcmp(argv[3],"row") != 0 && strcmp(argv[3],"col") != 0 &&
+		strcmp(argv[3],"tile") != 0){
 		printf("%s", "invalid partition argument");
 		exit(1);
 	}
@@ -219,273 +300,119 @@ void verifyCommandArg(char** argv, int argc,FILE* inFile){
 }
 
 /**
- * Gets the size of the grid and the number of iterations from the user
- * @param row: pointer to int row in main, contains # of rows in the grid
- * @param col: pointer to int col in main, contains # of columns in the grid
- * @param inFile: FILE ptr that has opened the file entered by the user
- * @returns: returns the number of iterations from file
+ * Reads the threads, partition and wrap arguments and the optional
+ * arguments that follow the positional ones and stores them in opts.
+ * Options not given keep their default value.
+ * @param argc: The amount of command line arguments
+ * @param argv: array containing the command line arguments input by the user
+ * @param opts: the options to fill in
+ * @param fopts: gets the options about the input file
+ * @param oopts: gets the outputs of the frames, the terminal for show
+ * @param run: gets the checkpoint, output and trace options, which are not the
+ *             simulator's
+ * @returns nothing
+ * @throws exit(1) error if an option is unknown or has an invalid value
  */
-int getSizeIterations(int* row, int*col, FILE* inFile){
-	int iterations;
+void getOptions(int argc, char** argv, simOptions* opts, fileOptions* fopts,
+	outputOptions* oopts, runOptions* run){
+	int i;
+	const char* error;
+	const char* value;
+	int first = 6; //first argument after the positional ones
 
-	//get first 3 lines from file (row, col, iterations)
-	if(fscanf(inFile, "%d", row) < 1){
-		printf("%s", "error getting rows from file");
-		exit(1);
+	if(strcmp(argv[5],"show") == 0){
+		first = 7;
 	}
-	if(fscanf(inFile, "%d", col) < 1){
-		printf("%s", "error getting columns from file");
-		exit(1);
+	defaultSimOptions(opts);
+	opts->numThreads = atoi(argv[2]);
+	if(strcmp(argv[3],"col") == 0){
+		opts->partition = PARTITION_COL;
 	}
-	if(fscanf(inFile, "%d", &iterations) < 1){
-		printf("%s", "error getting iterations from file");
-		exit(1);
+	else if(strcmp(argv[3],"tile") == 0){
+		opts->partition = PARTITION_TILE;
 	}
-
-	return iterations;
-}
-
-/**
- * Gets the live cells in the initial state of the grid from the file and sets
- * those cells to alive on the board.
- * @param board: pointer to the 2d integer array that makes up the initial board
- * @param inFile: FILE ptr that has opened the file entered by the user
- * @returns: nothing
- */
-void GetBoardStateFromFile(int** board, FILE* inFile){
-	int row;
-	int col;
-	int scanResult;
-	int success = 1;
-
-	//get live cells from file and set them to alive in the initial board
-	while(success == 1){
-		scanResult = fscanf(inFile, "%d%d", &row,&col);
-		if (scanResult != EOF){
-			if(scanResult < 2){
-				printf("%s", "error reading file");
+	opts->wrap = strcmp(argv[4],"wrap") == 0;
+	run->checkpointEvery = 0;
+	run->checkpointFile = CHECKPOINT_FILE;
+	run->resumeFile = NULL;
+	run->outputFile = NULL;
+	run->traceFile = NULL;
+	defaultFileOptions(fopts);
+	defaultOutputOptions(oopts);
+	oopts->delay = getShowType(argv);
+	oopts->screen = oopts->delay != 0;
+
+	for(i = first; i < argc; i++){
+		if(parseFileOption(fopts,argv[i],&error)){
+			if(error != NULL){
+				printf("%s", error);
 				exit(1);
 			}
-			board[row][col] = 1;
-			currentLiveCount++;
+			continue;
 		}
-		else{
-			success = 0;
-		}		
-	}
-
-}
-
-/**
- * Dynamically allocates memory for a grid(2D array) of size row x col and sets
- * allinitial values to 0
- * @param row: the number of rows in the grid
- * @param col: the number of columns in the grid
- * @return: returns a pointer to the newly initialized 2D array
- */
-int** initializeBoard(int row, int col){
-	int i;
-	int j;
-	int** board;
-
-	//allocate memory space for 2D int array of size[row,col]
-	board = (int**) malloc(row * sizeof(int*));
-	for(i = 0; i < row; i++){
-		board[i] = (int*) malloc(col * sizeof(int));
-	}
-	//set all initial values in 2D array to 0 (dead)
-	for(i = 0; i < row; i++){
-		for(j = 0; j < row; j++){
-			board[i][j] = 0;
+		if(strncmp(argv[i],"--frames=",9) == 0 && argv[i][9] != '\0'){
+			oopts->frameDir = argv[i] + 9;
+			continue;
 		}
-	}
-	return board;
-}
-
-/**
- * Prints the partition information for a thread
- * @param threadNum: number of the thread being printed 
- * @param numThreads: The total number of threads
- * @param begRow: The start row for the thread
- * @param begCol: The start col for the thread
- * @param endRow: The end row for the thread
- * @param endCol: The end col for the thread
- * @param rowMax: The number of rows in the grid
- * @param colMax: The number of columns in the grid
- * @return nothing
- */
-void printPartition(int threadNum,int numThreads ,int begRow, int endRow, 
-		int begCol,int endCol,int rowMax,int colMax){
-
-	int num,rowForm,colForm,threadNumForm;
-	colForm = 0;
-	rowForm = 0;
-	threadNumForm = 0;
-	num = rowMax+1;
-   	while(num != 0) {
-      	num = num / 10;
-      	rowForm++;
-   	}
-   	num = colMax+1;
-   	while(num != 0) {
-      	num = num / 10;
-      	colForm++;
-   	}
-   	num = numThreads-1;
-   	while(num != 0) {
-      	num = num / 10;
-      	threadNumForm++;
-   	}
-
-	printf("Thread %*d: Rows: %*d:%*d (%*d) Cols: %*d:%*d (%*d)\n",
-		threadNumForm,threadNum,rowForm,begRow,rowForm,endRow,rowForm,
-		endRow-begRow+1,colForm,begCol,colForm,endCol,colForm,endCol-begCol+1);
-	fflush(stdout);
-}
-
-/**
- * Prints the contents of a 2D integer array on screen
- * @param board: pointer to the 2D integer array to be printed on screen
- * @param row: the number of rows in the array
- * @param col: the number of columns in the array 
- * @return nothing
- */
-void displayBoard(int** board, int row, int col){
-	int i;
-	int j;
-
-	//print each cell of the board in order
-	for(i = 0; i < row; i++){
-		for(j = 0; j < col; j++){
-			if(board[i][j] == 0){
-				printf("-");
-			}
-			else{
-				printf("@");
-			}
+		if(strncmp(argv[i],"--record=",9) == 0 && argv[i][9] != '\0'){
+			oopts->recordFile = argv[i] + 9;
+			continue;
 		}
-		//end of row, new line
-		printf("\n");
-	}
-}
-
-/**
- * Calculates and returns the number of living neighbors that the cell at
- * [curRow,curCol] in the grid has. Used for checking neighbors when
- * the grid is both wrapped and not wrapped
- * @param board: pointer to the current grid 
- * @param curRow: row of the cell whose neighbors are being checked
- * @param curCol: col of the cell whose neighbors are being checked
- * @param rowMax: number of rows in the grid
- * @param colMax: number of columns in the grid
- * @param wrap: string containing "wrap" or "nowrap"
- * @return: returns the number of living neighbors the cell has
- */
-int checkNeighbors(int** board, int curRow, int curCol, int rowMax,
-	int colMax, int wrap){
-	int i,j; //loop variables
-	//wrapRow and wrapCol are used for calculations in place of i and j
-	//in the wrap section so i and j remain unchanged and iterate properly.
-	int wrapRow,wrapCol;
-	int liveNeighbors = 0;
-
-	//Calculate neighbors if nowrap
-	if (wrap == 0){
-		for(i = curRow-1; i < curRow+2; i++){
-			if(i >= 0 && i < rowMax){
-				for(j = curCol-1;j < curCol+2;j++){
-					if(j >= 0 && j < colMax){
-						if(board[i][j] == 1 && (i != curRow || j != curCol)){
-							liveNeighbors++;
-						}
-					}
-				}
-			}
+		if(strcmp(argv[i],"--drop-frames") == 0){
+			oopts->dropFrames = 1;
+			continue;
 		}
-	}
-	//calculate neighbors if wrap
-	else{
-		for(i = curRow-1; i < curRow+2; i++){
-			wrapRow = i;
-			//if neighbor is out of bounds row-wise, wrap row
-			if(wrapRow < 0){
-				wrapRow = rowMax -1;
-			}
-			else if(wrapRow >= rowMax){
-				wrapRow = 0;
-			}
-			for(j = curCol-1;j < curCol+2;j++){
-				wrapCol = j;
-				//if neighbor is out of bounds col-wise, wrap col
-				if(wrapCol < 0){
-					wrapCol = colMax -1;
-				}
-				else if(wrapCol >= colMax){
-					wrapCol = 0;
-				}
-				//if neighbor is alive and is not the cell itself		
-				if(board[wrapRow][wrapCol] == 1 && (i!=curRow || j!=curCol)){
-					liveNeighbors++;
-				}
+		if(strncmp(argv[i],"--ring=",7) == 0){
+			value = argv[i] + 7;
+			if(*value == '\0' || strlen(value) > 6 ||
+				strspn(value,"0123456789") != strlen(value) ||
+				atoi(value) <= 0){
+				printf("%s", "invalid ring argument");
+				exit(1);
 			}
+			oopts->ringSize = atoi(value);
+			continue;
 		}
-	}
-	return liveNeighbors;	
-}
-
-/**
- * Calculates the status of each cell for the next iteration and assigns the
- * corresponding values in the board for the next iteration.
- * @param currentBoard: pointer to the grid for the current iteration
- * @param nextBoard: pointer to the grid for the next iteration
- * @param row: The number of rows in the grid
- * @param col: The number of columns in the grid
- * @param begRow: The start row for the thread
- * @param begCol: The start col for the thread
- * @param endRow: The end row for the thread
- * @param endCol: The end col for the thread
- * @param wrap: string containing 0 for nowrap 1 for wrap
- * @return nothing
- */
-void calcNextIteration(int** currentBoard, int** nextBoard,int row,int col,
-		int begRow, int begCol,int endCol,int endRow,int wrap){
-	int i;
-	int j;
-	int curNeighbors;
-
-	for(i = begRow; i < endRow; i++){
-		for(j = begCol; j < endCol; j++){
-			curNeighbors = checkNeighbors(currentBoard,i,j,row,col,wrap);
-			//if cell is dead
-			if(currentBoard[i][j] == 0){
-				if(curNeighbors == 3){
-					nextBoard[i][j] = 1;
-					pthread_mutex_lock(&m);
-					currentLiveCount++;
-					totalLiveCount++;
-					// release lock
-					pthread_mutex_unlock(&m);
-				}
-				else{
-					nextBoard[i][j] = 0;
-				}
-			}
-			//if cell is alive
-			else{
-				if(curNeighbors == 2 || curNeighbors == 3){
-					nextBoard[i][j] = 1;
-					pthread_mutex_lock(&m);
-					currentLiveCount++;
-					totalLiveCount++;
-					// release lock
-					pthread_mutex_unlock(&m);
-					
-				}
-				else{
-					nextBoard[i][j] = 0;
-				}
+		if(strncmp(argv[i],"--output=",9) == 0 && argv[i][9] != '\0'){
+			run->outputFile = argv[i] + 9;
+			continue;
+		}
+		if(strncmp(argv[i],"--checkpoint=",13) == 0){
+			value = argv[i] + 13;
+			if(*value == '\0' || strlen(value) > 9 ||
+				strspn(value,"0123456789") != strlen(value) ||
+				atoi(value) <= 0){
+				printf("%s", "invalid checkpoint argument");
+				exit(1);
 			}
+			run->checkpointEvery = atoi(value);
+			continue;
 		}
+		if(strncmp(argv[i],"--checkpoint-file=",18) == 0 &&
+			argv[i][18] != '\0'){
+			run->checkpointFile = argv[i] + 18;
+			continue;
+		}
+		if(strncmp(argv[i],"--resume=",9) == 0 && argv[i][9] != '\0'){
+			run->resumeFile = argv[i] + 9;
+			continue;
+		}
+		if(strncmp(argv[i],"--trace=",8) == 0 && argv[i][8] != '\0'){
+			run->traceFile = argv[i] + 8;
+			continue;
+		}
+		error = parseSimOption(opts,argv[i]);
+		if(error != NULL){
+			printf("%s", error);
+			exit(1);
+		}
+	}
+	//every generation is displayed
+	if(first == 7){
+		opts->depth = 1;
+	}
+	if(run->traceFile != NULL){
+		opts->profile = PROFILE_TRACE;
 	}
 }
 
@@ -514,172 +441,158 @@ int getShowType(char *argv[]) {
 }
 
 /**
- * Partitions the boards into sections based on row or col partitioning.
- * This is based on the number of threads so the number of rows are columns
- * are spread as evenly as they can be across the threads.
- * @param numThreads: The number of threads created
- * @param row: The number of rows in the grid
- * @param col: The number of columns in the grid
- * @param partType: The type of partition, row or col
- * @param threadInput: The array of thread inputs
+ * Loads the board read from the input file into the simulator, or the
+ * checkpoint to resume from if one was given. The checkpoint must be of
+ * the same size as the input file's board.
+ * @param sim: the simulator
+ * @param board: the input file's contents
+ * @param run: the checkpoint options
+ * @param wrap: 0 for nowrap 1 for wrap
  * @return nothing
+ * @throws exit(1) if the board or the checkpoint can not be loaded
  */
-void partition(int numThreads,int row,int col,char* partType,
-	threadArg* threadInput){
-	int i;
-	int numGetMaxPart;
-	int maxPart;
-	int begRowCol;
-	int endRowCol;
-
-	if(strcmp(partType,"row") == 0){
-		numGetMaxPart = row % numThreads;
-		maxPart = row / numThreads;
+void loadBoard(simulator* sim, boardFile* board, runOptions* run, int wrap){
+	checkpoint* cp;
+	const char* error;
+
+	if(run->resumeFile == NULL && board->bits != NULL){
+		//a pattern is already bit-packed, it loads like a checkpoint
+		board->bits->wrap = wrap;
+		if(resumeSimulator(sim,board->bits) != 0){
+			printf("%s", simulatorError(sim));
+			exit(1);
+		}
+		return;
 	}
-	else{
-		numGetMaxPart = col % numThreads;
-		maxPart = col / numThreads;
+	if(run->resumeFile == NULL){
+		if(loadSimulator(sim,board->rows,board->cols,board->cells,
+			board->numCells) != 0){
+			printf("%s", simulatorError(sim));
+			exit(1);
+		}
+		return;
 	}
-
-	if(numGetMaxPart != 0){
-		maxPart++;
+	cp = loadCheckpoint(run->resumeFile,&error);
+	if(cp == NULL){
+		printf("%s", error);
+		exit(1);
 	}
-	else{
-		numGetMaxPart = numThreads;
+	if(cp->rows != board->rows || cp->cols != board->cols){
+		printf("%s", "checkpoint size does not match the input file");
+		exit(1);
 	}
-
-	for(i = 0; i < numThreads;i++){
-		if(i < numGetMaxPart){
-			begRowCol = maxPart*i;
-			endRowCol = maxPart*(i+1)-1;
-		}
-		else{
-			begRowCol = maxPart*numGetMaxPart + (maxPart-1)*(i-numGetMaxPart);
-			endRowCol = maxPart*numGetMaxPart+(maxPart-1)*(i+1-numGetMaxPart)-1;
-		}
-		if(strcmp(partType,"row") == 0){
-			threadInput[i].begRow = begRowCol;
-			threadInput[i].endRow = endRowCol;
-			threadInput[i].begCol = 0;
-			threadInput[i].endCol = col-1;
-		}
-		else{
-			threadInput[i].begCol = begRowCol;
-			threadInput[i].endCol = endRowCol;
-			threadInput[i].begRow = 0;
-			threadInput[i].endRow = row-1;
-		}
+	if(resumeSimulator(sim,cp) != 0){
+		printf("%s", simulatorError(sim));
+		exit(1);
 	}
+	freeCheckpoint(cp);
 }
 
 /**
- * Passes values into the threadArg array so each thread gets the info it 
- * needs to run the specific slice of the game given to them.
- * @param numThreads: The number of threads created 
- * @param iterations: Number of iterations to run game specified in input file. 
- * @param row: The number of rows in the grid
- * @param col: The number of columns in the grid
- * @param wrap: string containing "wrap" or "nowrap"
- * @param show: Type of show containing hide, slow, med, fast as int speeds
- * @param currentBoard: pointer to the grid for the current iteration
- * @param nextBoard: pointer to the grid for the next iteration
- * @return an array of threadArg inputs
+ * Writes the final board to a file as RLE
+ * @param sim: the simulator
+ * @param fileName: the name of the file
+ * @return nothing
+ * @throws exit(1) if the file can not be written
  */
-threadArg* initializeThreadInput(int numThreads, int iterations,int row,
-	int col,char* wrap, int show, int** currentBoard, int** nextBoard){
-	int i = 0;
-	int wrapInt = 0;
-	threadArg* threadInput;
-
-	if(strcmp(wrap,"wrap") == 0){
-		wrapInt = 1;
-	}
-	threadInput = (threadArg*) malloc(numThreads*sizeof(threadArg));
-	for(i = 0; i < numThreads; i++){
-		threadInput[i].iterations = iterations;
-		threadInput[i].maxRow = row;
-		threadInput[i].maxCol = col;
-		threadInput[i].wrap = wrapInt;
-		threadInput[i].showSpeed = show;
-		threadInput[i].currentBoard = currentBoard;
-		threadInput[i].nextBoard = nextBoard;
-		threadInput[i].threadNum = i;
-		threadInput[i].numThreads = numThreads;
-	}
-
-	return threadInput;
+void writeOutput(simulator* sim, const char* fileName){
+	checkpoint* cp;
+	FILE* outFile;
+	int failed;
+
+	outFile = fopen(fileName, "w");
+	if(outFile == NULL){
+		printf("%s", "Error opening output file.");
+		exit(1);
+	}
+	cp = snapshotSimulator(sim);
+	failed = writeRleFile(outFile,cp) != 0;
+	failed = fclose(outFile) != 0 || failed;
+	freeCheckpoint(cp);
+	if(failed){
+		printf("%s", "error writing output file");
+		exit(1);
+	}
 }
 
 /**
- * Driver function for the simulation. Calls the function to calculate the
- * next iteration the appropriate amount of times and calls the function to
- * display the board for each iteration (if show). Sleeps the origin thread
- * each iteration for the appropriate amount of time corresponding to the 
- * speed entered by the user (if show). Each thread is given a slice.
- * @param arguments: pointer to a struct of arguments for the thread
- * @return NULL
+ * Runs the simulation up to the given generation. Without frame outputs
+ * the generations are calculated in one call, or one call per checkpoint.
+ * With them a copy of the board is added to the frame queue before the
+ * first generation and after each one; the queue's thread shows them, at
+ * the speed entered by the user for show, while the next ones are
+ * calculated. A checkpoint is queued on the writer every time the
+ * generation reaches a multiple of every.
+ * @param sim: the simulator, with the board loaded
+ * @param iterations: Generation to stop at
+ * @param every: Generations between checkpoints
+ * @param writer: the checkpoint writer, NULL for no checkpoints
+ * @param frames: the frame queue, NULL for no frame outputs
+ * @return nothing
  */
-void* runSlice(void* arguments){
-	threadArg localArg = ((threadArg*) arguments)[0];
-	int i;
-	int** swapTemp;
-	
-	if(localArg.begRow == 0 && localArg.begCol == 0){
-		system("clear");
-	}
-	for(i = 0; i < localArg.iterations;i++){
-		//display each iteration if show
-		if(localArg.showSpeed != 0){
-			if(localArg.begRow == 0 && localArg.begCol == 0){
-				displayBoard(localArg.currentBoard,
-				localArg.maxRow,localArg.maxCol);
-				//print number of live cells
-				printf("\nThere are %d live cells in this board\n", 
-				currentLiveCount);
-				fflush(stdout);
-				usleep(localArg.showSpeed);
-				system("clear");
-			}
+void runShow(simulator* sim, int iterations, int every,
+	checkpointWriter* writer, frameQueue* frames){
+	int steps;
+
+	if(frames != NULL){
+		queueFrame(frames,snapshotSimulator(sim));
+	}
+	while(simulatorGeneration(sim) < iterations){
+		steps = iterations - simulatorGeneration(sim);
+		if(frames != NULL){
+			steps = 1;
+		}
+		else if(writer != NULL &&
+			every - simulatorGeneration(sim) % every < steps){
+			steps = every - simulatorGeneration(sim) % every;
+		}
+		stepSimulator(sim,steps);
+		if(frames != NULL){
+			queueFrame(frames,snapshotSimulator(sim));
 		}
-		if(localArg.begRow == 0 && localArg.begCol == 0){
-			currentLiveCount = 0;
+		if(writer != NULL && simulatorGeneration(sim) % every == 0){
+			queueCheckpoint(writer,snapshotSimulator(sim));
 		}
-		pthread_barrier_wait(&threadBarrier);
-		calcNextIteration(localArg.currentBoard,localArg.nextBoard,
-			localArg.maxRow,localArg.maxCol,localArg.begRow,localArg.begCol,
-			localArg.endCol+1,localArg.endRow+1,localArg.wrap);
-		//swap boards so the previous "next iteration" is the current board
-		swapTemp = localArg.currentBoard;
-		localArg.currentBoard = localArg.nextBoard;
-		localArg.nextBoard = swapTemp;
-		pthread_barrier_wait(&threadBarrier);
-	}
-	//display final grid
-	if(localArg.begRow == 0 && localArg.begCol == 0){
-		printFinal(localArg.currentBoard,localArg.maxRow,localArg.maxCol);
-	}
-	pthread_barrier_wait(&threadBarrier);
-	// printf("Thread %d: ",localArg.threadNum);
-	printPartition(localArg.threadNum,localArg.numThreads,localArg.begRow,
-		localArg.endRow,localArg.begCol,localArg.endCol,localArg.maxRow,
-		localArg.maxCol);
-
-	return NULL;
+	}
 }
 
 /**
- * Prints the final board and related live cell count information
- * @param currentBoard: pointer to the grid for the current iteration
- * @param maxRow: The number of rows in the grid
- * @param maxCol: The number of columns in the grid
+ * Prints the live cell count information that follows the final board, and
+ * the cycle the board settled into if one was found
+ * @param sim: the simulator
  * @return nothing
  */
-void printFinal(int** currentBoard, int maxRow, int maxCol){
-	displayBoard(currentBoard,maxRow,maxCol);
+void printLiveCounts(simulator* sim){
 	//print number of live cells
-	printf("\nThere are %d live cells in this board.\n", currentLiveCount);
+	printf("\nThere are %lld live cells in this board.\n",
+		simulatorLiveCount(sim));
 	// Print total live cells
-	printf("There were a total of %d live cells during the simulation.\n\n",
-	totalLiveCount);
+	printf("There were a total of %lld live cells during the simulation.\n\n",
+	simulatorTotalLiveCount(sim));
+	if(simulatorPeriod(sim) == 1){
+		printf("The board was a still life from generation %d.\n\n",
+			simulatorStableGeneration(sim));
+	}
+	else if(simulatorPeriod(sim) > 1){
+		printf("The board repeated every %d generations from generation "
+			"%d.\n\n", simulatorPeriod(sim),simulatorStableGeneration(sim));
+	}
+	fflush(stdout);
+}
+
+/**
+ * Prints how many tiles of the active region were recalculated, to compare
+ * with recalculating every tile each generation
+ * @param sim: the simulator, with an active region
+ * @param iterations: Number of iterations that were run
+ * @return nothing
+ */
+void printTileCounts(simulator* sim, int iterations){
+	long long allTiles = (long long) simulatorTileCount(sim) * iterations;
+	long long processed = simulatorTotalTilesProcessed(sim);
+
+	printf("Tiles processed: %lld of %lld (%0.1f%%)\n\n",
+		processed,allTiles,
+		allTiles == 0 ? 0.0 : 100.0 * processed / allTiles);
 	fflush(stdout);
 }
@@ -0,0 +1,260 @@
+//output.c
+//Description: Frame output of a run. The ring is a circular array of
+//             frames guarded by one mutex, with one condition for the
+//             consumer waiting on an empty ring and one for a producer
+//             waiting on a full one. The consumer writes a frame outside of
+//             the lock, so adding a frame only ever waits on a full ring.
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include "bitboard.h"
+#include "boardfile.h"
+#include "output.h"
+
+/**
+ * Fills in the default output options: no output, FRAME_RING frames and
+ * waiting for room in the ring
+ * @param oopts: the options to fill in
+ * @return nothing
+ */
+void defaultOutputOptions(outputOptions* oopts){
+	oopts->screen = 0;
+	oopts->delay = 0;
+	oopts->frameDir = NULL;
+	oopts->recordFile = NULL;
+	oopts->ringSize = FRAME_RING;
+	oopts->dropFrames = 0;
+}
+
+/**
+ * Checks if any output of the frames was asked for
+ * @param oopts: the options
+ * @return: 1 if frames are wanted, 0 if no queue is needed
+ */
+int outputWanted(const outputOptions* oopts){
+	return oopts->screen || oopts->frameDir != NULL ||
+		oopts->recordFile != NULL;
+}
+
+/**
+ * Writes a frame as a binary PBM image (P4), a live cell black. Rows of the
+ * image are packed 8 cells per byte, the first cell in the highest bit.
+ * @param frame: the board
+ * @param fileName: the name of the image file
+ * @return: 0 on success, -1 if the file could not be written
+ */
+static int writePbmFrame(const checkpoint* frame, const char* fileName){
+	FILE* outFile;
+	unsigned char* line;
+	unsigned char byte, reversed;
+	int bytes = (frame->cols + 7) / 8;
+	int row, i, bit;
+	int failed = 0;
+
+	outFile = fopen(fileName, "wb");
+	line = (unsigned char*) malloc(bytes);
+	if(outFile == NULL || line == NULL){
+		if(outFile != NULL){
+			fclose(outFile);
+		}
+		free(line);
+		return -1;
+	}
+	fprintf(outFile, "P4\n%d %d\n", frame->cols, frame->rows);
+	for(row = 0; row < frame->rows && !failed; row++){
+		for(i = 0; i < bytes; i++){
+			byte = (unsigned char) (frame->bits[(size_t) row * frame->words +
+				i / 8] >> (8 * (i % 8)));
+			reversed = 0;
+			for(bit = 0; bit < 8; bit++){
+				reversed |= ((byte >> bit) & 1) << (7 - bit);
+			}
+			line[i] = reversed;
+		}
+		failed = fwrite(line, 1, bytes, outFile) != (size_t) bytes;
+	}
+	free(line);
+	failed = fclose(outFile) != 0 || failed;
+	return failed ? -1 : 0;
+}
+
+/**
+ * Sends a frame to every output of the queue
+ * @param q: the queue
+ * @param frame: the frame
+ * @return: the number of outputs that could not be written
+ */
+static int writeFrame(frameQueue* q, const checkpoint* frame){
+	char* fileName;
+	int failures = 0;
+
+	if(q->screen != NULL){
+		drawFrame(q->screen,frame);
+	}
+	if(q->frameDir != NULL){
+		fileName = (char*) malloc(strlen(q->frameDir) + 32);
+		if(fileName == NULL){
+			return 1;
+		}
+		sprintf(fileName, "%s/frame%06d.pbm", q->frameDir,
+			frame->generation);
+		failures += writePbmFrame(frame,fileName) != 0;
+		free(fileName);
+	}
+	if(q->record != NULL){
+		failures += writeRleFile(q->record,frame) != 0;
+	}
+	return failures;
+}
+
+/**
+ * Driver function of the consumer thread. Takes the oldest frame out of the
+ * ring and writes it until it is told to quit and the ring is empty.
+ * @param arguments: pointer to the frameQueue
+ * @return NULL
+ */
+static void* runFrameQueue(void* arguments){
+	frameQueue* q = (frameQueue*) arguments;
+	checkpoint* frame;
+	int failures;
+
+	pthread_mutex_lock(&q->lock);
+	while(1){
+		while(q->count == 0 && !q->quit){
+			pthread_cond_wait(&q->notEmpty, &q->lock);
+		}
+		if(q->count == 0){
+			break;
+		}
+		frame = q->ring[q->head];
+		q->head = (q->head + 1) % q->capacity;
+		q->count--;
+		q->frames++;
+		pthread_cond_signal(&q->notFull);
+		pthread_mutex_unlock(&q->lock);
+		failures = writeFrame(q,frame);
+		freeCheckpoint(frame);
+		if(q->screen != NULL && q->delay > 0){
+			usleep(q->delay);
+		}
+		pthread_mutex_lock(&q->lock);
+		q->failures += failures;
+	}
+	pthread_mutex_unlock(&q->lock);
+	return NULL;
+}
+
+/**
+ * Starts the consumer thread of a run's frames
+ * @param oopts: the outputs, ring size and policy
+ * @param rows: the number of rows of the board
+ * @param cols: the number of columns of the board
+ * @return: the queue
+ * @throws exit(1) if the queue can not be allocated, its thread created or
+ *                 an output opened
+ */
+frameQueue* startFrameQueue(const outputOptions* oopts, int rows, int cols){
+	frameQueue* q;
+	struct stat info;
+
+	q = (frameQueue*) malloc(sizeof(frameQueue));
+	if(q == NULL){
+		printf("%s", "error allocating frame queue");
+		exit(1);
+	}
+	memset(q, 0, sizeof(frameQueue));
+	q->capacity = oopts->ringSize;
+	q->dropFrames = oopts->dropFrames;
+	q->delay = oopts->delay;
+	q->frameDir = oopts->frameDir;
+	q->ring = (checkpoint**) malloc(q->capacity * sizeof(checkpoint*));
+	if(q->ring == NULL){
+		printf("%s", "error allocating frame queue");
+		exit(1);
+	}
+	if(q->frameDir != NULL && (stat(q->frameDir, &info) != 0 ||
+		!S_ISDIR(info.st_mode))){
+		printf("%s", "Error opening frames directory.");
+		exit(1);
+	}
+	if(oopts->recordFile != NULL){
+		q->record = fopen(oopts->recordFile, "w");
+		if(q->record == NULL){
+			printf("%s", "Error opening record file.");
+			exit(1);
+		}
+	}
+	if(oopts->screen){
+		fflush(stdout);
+		q->screen = initializeRenderer(rows,cols);
+	}
+	pthread_mutex_init(&q->lock, NULL);
+	pthread_cond_init(&q->notEmpty, NULL);
+	pthread_cond_init(&q->notFull, NULL);
+	if(pthread_create(&q->thread,NULL,runFrameQueue,q) != 0){
+		printf("%s", "error creating threads");
+		exit(1);
+	}
+	return q;
+}
+
+/**
+ * Adds a frame to the ring. When the ring is full the oldest frame is
+ * dropped or, if frames are not dropped, the call waits for the consumer
+ * to take one out.
+ * @param q: the queue
+ * @param frame: the frame, freed by the queue
+ * @return nothing
+ */
+void queueFrame(frameQueue* q, checkpoint* frame){
+	checkpoint* old = NULL;
+
+	pthread_mutex_lock(&q->lock);
+	if(q->count == q->capacity && q->dropFrames){
+		old = q->ring[q->head];
+		q->head = (q->head + 1) % q->capacity;
+		q->count--;
+		q->dropped++;
+	}
+	while(q->count == q->capacity){
+		pthread_cond_wait(&q->notFull, &q->lock);
+	}
+	q->ring[(q->head + q->count) % q->capacity] = frame;
+	q->count++;
+	pthread_cond_signal(&q->notEmpty);
+	pthread_mutex_unlock(&q->lock);
+	freeCheckpoint(old);
+}
+
+/**
+ * Writes the frames left in the ring, ends the consumer thread, prints how
+ * many frames were written and dropped and frees the queue
+ * @param q: the queue
+ * @return: the number of frames that could not be written
+ */
+int stopFrameQueue(frameQueue* q){
+	int failures;
+
+	pthread_mutex_lock(&q->lock);
+	q->quit = 1;
+	pthread_cond_signal(&q->notEmpty);
+	pthread_mutex_unlock(&q->lock);
+	pthread_join(q->thread,NULL);
+	if(q->screen != NULL){
+		freeRenderer(q->screen);
+	}
+	if(q->record != NULL && fclose(q->record) != 0){
+		q->failures++;
+	}
+	printf("%lld frames output, %lld dropped\n", q->frames, q->dropped);
+	failures = q->failures;
+	pthread_mutex_destroy(&q->lock);
+	pthread_cond_destroy(&q->notEmpty);
+	pthread_cond_destroy(&q->notFull);
+	free(q->ring);
+	free(q);
+	return failures;
+}
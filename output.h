@@ -0,0 +1,61 @@
+//output.h
+//Description: Frame output of a run, decoupled from the simulation. The
+//             thread stepping the simulator adds a bit-packed copy of each
+//             generation to a bounded ring and goes on; a consumer thread
+//             takes the frames out at its own pace and sends them to the
+//             terminal (render.h), to a directory of PBM images, one per
+//             generation, that a video encoder can take, and to a file
+//             recording every frame as RLE. When the ring is full the
+//             producer either waits for room or drops the oldest frame.
+//             Runs without any output create no queue and take no copies.
+
+#ifndef OUTPUT_H
+#define OUTPUT_H
+
+#include <stdio.h>
+#include <pthread.h>
+#include "checkpoint.h"
+#include "render.h"
+
+#define FRAME_RING 16 // Default frames the ring holds
+
+typedef struct outputOptions{
+	int screen; // 1 to draw the frames on the terminal
+	int delay; // Microseconds to show each frame on the terminal
+	const char* frameDir; // Directory of the PBM frames, NULL for none
+	const char* recordFile; // File the frames are recorded to, NULL for none
+	int ringSize; // Frames the ring holds
+	int dropFrames; // 1 to drop the oldest frame when the ring is full
+} outputOptions;
+
+typedef struct frameQueue{
+	pthread_t thread; // Thread taking the frames out of the ring
+	pthread_mutex_t lock; // Protects the ring, quit and the counts
+	pthread_cond_t notEmpty; // Signaled when a frame is added or quit is set
+	pthread_cond_t notFull; // Signaled when a frame is taken out
+	checkpoint** ring; // Frames waiting, the oldest at head
+	int capacity; // Frames the ring holds
+	int head; // Index of the oldest frame
+	int count; // Frames in the ring
+	int quit; // Set to end the thread once the ring is empty
+	int dropFrames; // 1 to drop the oldest frame when full, 0 to wait
+	int delay; // Microseconds to sleep after drawing a frame
+	renderer* screen; // Terminal output, NULL for none
+	const char* frameDir; // Directory of the PBM frames, NULL for none
+	FILE* record; // File the frames are recorded to, NULL for none
+	long long frames; // Frames taken out of the ring
+	long long dropped; // Frames dropped because the ring was full
+	int failures; // Frames that could not be written
+} frameQueue;
+
+void defaultOutputOptions(outputOptions* oopts);
+
+int outputWanted(const outputOptions* oopts);
+
+frameQueue* startFrameQueue(const outputOptions* oopts, int rows, int cols);
+
+void queueFrame(frameQueue* q, checkpoint* frame);
+
+int stopFrameQueue(frameQueue* q);
+
+#endif /* OUTPUT_H */
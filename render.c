@@ -0,0 +1,270 @@
+//render.c
+//Description: Terminal renderer of show mode. The glyph of every character
+//             of a frame is worked out from the live cells alone, a word of
+//             64 dead cells is skipped at once, and compared with the glyph
+//             on the screen. Changed characters close to each other are
+//             written as one run after a single cursor move.
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/ioctl.h>
+#include "bitboard.h"
+#include "render.h"
+
+#define STATUS_LINES 3 // Lines under the board for the status
+#define MERGE_GAP 4 // Unchanged characters rewritten to save a cursor move
+
+/**
+ * Gets the size of the terminal on stdout, or 24x80 if it is not one
+ * @param termRows: set to the number of lines
+ * @param termCols: set to the number of columns
+ * @return nothing
+ */
+static void getTerminalSize(int* termRows, int* termCols){
+	struct winsize size;
+
+	*termRows = 24;
+	*termCols = 80;
+	if(ioctl(STDOUT_FILENO, TIOCGWINSZ, &size) == 0 && size.ws_row > 0 &&
+		size.ws_col > 0){
+		*termRows = size.ws_row;
+		*termCols = size.ws_col;
+	}
+}
+
+/**
+ * Appends bytes to the frame being built
+ * @param r: the renderer
+ * @param bytes: the bytes
+ * @param length: the number of bytes
+ * @return nothing
+ * @throws exit(1) if the buffer can not be allocated
+ */
+static void appendOut(renderer* r, const char* bytes, size_t length){
+	if(r->outLength + length > r->outCapacity){
+		while(r->outLength + length > r->outCapacity){
+			r->outCapacity *= 2;
+		}
+		r->out = (char*) realloc(r->out, r->outCapacity);
+		if(r->out == NULL){
+			printf("%s", "error allocating frame");
+			exit(1);
+		}
+	}
+	memcpy(r->out + r->outLength, bytes, length);
+	r->outLength += length;
+}
+
+/**
+ * Writes the frame built to stdout, with as few calls as the terminal
+ * allows
+ * @param r: the renderer
+ * @return nothing
+ */
+static void writeOut(renderer* r){
+	size_t written;
+	ssize_t bytes;
+
+	for(written = 0; written < r->outLength; written += bytes){
+		bytes = write(STDOUT_FILENO, r->out + written,
+			r->outLength - written);
+		if(bytes <= 0){
+			break;
+		}
+	}
+	r->outLength = 0;
+}
+
+/**
+ * Appends the bytes of a glyph: - or @ for one cell, a braille character
+ * (U+2800 plus the dots) or a space when no dot is lit for braille
+ * @param r: the renderer
+ * @param glyph: the glyph
+ * @return nothing
+ */
+static void appendGlyph(renderer* r, uint8_t glyph){
+	char bytes[3];
+
+	if(!r->braille){
+		appendOut(r, glyph ? "@" : "-", 1);
+	}
+	else if(glyph == 0){
+		appendOut(r, " ", 1);
+	}
+	else{
+		bytes[0] = (char) 0xE2;
+		bytes[1] = (char) (0xA0 + (glyph >> 6));
+		bytes[2] = (char) (0x80 + (glyph & 0x3F));
+		appendOut(r, bytes, 3);
+	}
+}
+
+/**
+ * Works out the glyph of every character of a frame from its live cells
+ * @param r: the renderer
+ * @param frame: the board
+ * @return nothing
+ */
+static void buildGlyphs(renderer* r, const checkpoint* frame){
+	//bit of the braille dot at row (0-3) and column (0-1) of a character
+	static const uint8_t dots[4][2] = {{0x01, 0x08}, {0x02, 0x10},
+		{0x04, 0x20}, {0x40, 0x80}};
+	const uint64_t* words;
+	uint64_t word;
+	int row, w, col, dotRow, dotCol;
+	uint8_t* glyphRow;
+
+	memset(r->glyphs, 0, (size_t) r->charRows * r->charCols);
+	for(row = 0; row < frame->rows; row++){
+		words = frame->bits + (size_t) row * frame->words;
+		dotRow = row / r->scale;
+		glyphRow = r->glyphs + (size_t) (r->braille ? dotRow / 4 : row) *
+			r->charCols;
+		for(w = 0; w < frame->words; w++){
+			word = words[w];
+			while(word != 0){
+				col = w * BITS_PER_WORD + __builtin_ctzll(word);
+				word &= word - 1;
+				if(col >= frame->cols){
+					break;
+				}
+				if(!r->braille){
+					glyphRow[col] = 1;
+					continue;
+				}
+				dotCol = col / r->scale;
+				glyphRow[dotCol / 2] |= dots[dotRow % 4][dotCol % 2];
+			}
+		}
+	}
+}
+
+/**
+ * Builds the bytes that turn the screen into a frame and writes them with
+ * one call. The first frame clears the screen and is drawn whole.
+ * @param r: the renderer
+ * @param frame: the board
+ * @return nothing
+ * @throws exit(1) if the frame buffer can not be allocated
+ */
+void drawFrame(renderer* r, const checkpoint* frame){
+	char text[128];
+	uint8_t* glyphs;
+	uint8_t* shown;
+	int row, col, last, next;
+	int length;
+
+	buildGlyphs(r,frame);
+	r->outLength = 0;
+	if(!r->drawn){
+		appendOut(r, "\x1b[H\x1b[2J", 7);
+	}
+	for(row = 0; row < r->charRows; row++){
+		glyphs = r->glyphs + (size_t) row * r->charCols;
+		shown = r->shown + (size_t) row * r->charCols;
+		col = 0;
+		while(col < r->charCols){
+			if(r->drawn && glyphs[col] == shown[col]){
+				col++;
+				continue;
+			}
+			//run of changes, with short unchanged gaps written over
+			last = col;
+			for(next = col + 1; next < r->charCols &&
+				next - last <= MERGE_GAP; next++){
+				if(!r->drawn || glyphs[next] != shown[next]){
+					last = next;
+				}
+			}
+			length = sprintf(text, "\x1b[%d;%dH", row + 1, col + 1);
+			appendOut(r, text, length);
+			for(; col <= last; col++){
+				appendGlyph(r,glyphs[col]);
+				shown[col] = glyphs[col];
+			}
+		}
+	}
+	length = sprintf(text, "\x1b[%d;1HGeneration %d, %lld live cells",
+		r->charRows + 2, frame->generation, frame->liveCount);
+	appendOut(r, text, length);
+	if(frame->tileCount > 0){
+		length = sprintf(text, ", tiles processed: %lld of %d",
+			frame->tilesProcessed, frame->tileCount);
+		appendOut(r, text, length);
+	}
+	if(r->braille){
+		length = sprintf(text, " (one dot per %dx%d cells)", r->scale,
+			r->scale);
+		appendOut(r, text, length);
+	}
+	appendOut(r, "\x1b[K", 3);
+	writeOut(r);
+	r->drawn = 1;
+}
+
+/**
+ * Sets up a renderer for a board, sized for the terminal on stdout. Nothing
+ * else may write to stdout until it is freed.
+ * @param rows: the number of rows of the board
+ * @param cols: the number of columns of the board
+ * @return: the renderer
+ * @throws exit(1) if the renderer can not be allocated
+ */
+renderer* initializeRenderer(int rows, int cols){
+	renderer* r;
+	int termRows, termCols;
+	int scaleRows, scaleCols;
+	size_t chars;
+
+	r = (renderer*) malloc(sizeof(renderer));
+	if(r == NULL){
+		printf("%s", "error allocating renderer");
+		exit(1);
+	}
+	memset(r, 0, sizeof(renderer));
+	getTerminalSize(&termRows,&termCols);
+	termRows = termRows > STATUS_LINES ? termRows - STATUS_LINES : 1;
+	r->scale = 1;
+	if(rows <= termRows && cols <= termCols){
+		r->charRows = rows;
+		r->charCols = cols;
+	}
+	else{
+		r->braille = 1;
+		scaleRows = (rows + 4 * termRows - 1) / (4 * termRows);
+		scaleCols = (cols + 2 * termCols - 1) / (2 * termCols);
+		r->scale = scaleRows > scaleCols ? scaleRows : scaleCols;
+		r->charRows = ((rows + r->scale - 1) / r->scale + 3) / 4;
+		r->charCols = ((cols + r->scale - 1) / r->scale + 1) / 2;
+	}
+	chars = (size_t) r->charRows * r->charCols;
+	r->glyphs = (uint8_t*) malloc(chars);
+	r->shown = (uint8_t*) malloc(chars);
+	r->outCapacity = chars * 3 + 256;
+	r->out = (char*) malloc(r->outCapacity);
+	if(r->glyphs == NULL || r->shown == NULL || r->out == NULL){
+		printf("%s", "error allocating renderer");
+		exit(1);
+	}
+	return r;
+}
+
+/**
+ * Leaves the cursor on the line under the status line and frees a renderer
+ * @param r: the renderer
+ * @return nothing
+ */
+void freeRenderer(renderer* r){
+	char text[32];
+	int length;
+
+	length = sprintf(text, "\x1b[%d;1H", r->charRows + 3);
+	appendOut(r, text, length);
+	writeOut(r);
+	free(r->glyphs);
+	free(r->shown);
+	free(r->out);
+	free(r);
+}
@@ -0,0 +1,39 @@
+//render.h
+//Description: Terminal renderer of show mode. Frames are bit-packed copies
+//             of the board (checkpoints), drawn by the thread of the frame
+//             queue (output.h) so the simulation never waits on the
+//             terminal. Each frame is built in one buffer and written with
+//             one call, and only the characters that changed since the
+//             previous frame are redrawn, reached with ANSI cursor
+//             positioning. A board that fits the terminal is drawn one
+//             character per cell, a larger one is downsampled to braille
+//             characters of 2x4 dots, a dot lit when any cell of its square
+//             block is alive.
+
+#ifndef RENDER_H
+#define RENDER_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include "checkpoint.h"
+
+typedef struct renderer{
+	int braille; // 1 if each character holds 2x4 dots, 0 for one cell
+	int scale; // Rows and columns of cells per dot (braille)
+	int charRows; // Rows of characters of the board
+	int charCols; // Columns of characters of the board
+	uint8_t* glyphs; // Glyph of each character of the frame being built
+	uint8_t* shown; // Glyph of each character on the screen
+	int drawn; // 1 once the screen holds a whole frame
+	char* out; // Bytes of the frame being built
+	size_t outLength; // Bytes in out
+	size_t outCapacity; // Bytes out can hold
+} renderer;
+
+renderer* initializeRenderer(int rows, int cols);
+
+void drawFrame(renderer* r, const checkpoint* frame);
+
+void freeRenderer(renderer* r);
+
+#endif /* RENDER_H */
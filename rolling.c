@@ -0,0 +1,104 @@
+//rolling.c
+//Description: Rolling-sum step kernel for the board. A region is walked
+//             down in strips of at most ROLLING_STRIP columns, so the three
+//             rows the column sums are made of and the sums themselves stay
+//             in a few kilobytes on the stack whatever the width of the
+//             board. The halo of the board holds the neighbors past the
+//             edges for both wrap and nowrap, so the strips of every
+//             partition read the row above and below the region and the
+//             column left and right of it from the board like any other.
+
+#include <string.h>
+#include "board.h"
+#include "rolling.h"
+
+#define ROLLING_STRIP 512 // Most columns of a strip
+
+/**
+ * Calculates the next iteration of a strip of a region. rows keeps a copy
+ * of the three rows in the sums, taken as each entered them, and the row
+ * leaving the sums is replaced by the one entering, so only the entering
+ * row is read from the board. Both loops over a row are free of branches
+ * and are vectorized, which -O2 alone does not do for them.
+ * @param currentBoard: the board for the current iteration
+ * @param nextBoard: the board for the next iteration
+ * @param begRow: The start row of the region
+ * @param begCol: The start col of the strip
+ * @param endCol: One past the end col of the strip
+ * @param endRow: One past the end row of the region
+ * @return: the number of live cells in the strip of nextBoard
+ */
+__attribute__((optimize("tree-vectorize","vect-cost-model=dynamic")))
+static int calcStrip(cellBoard* currentBoard, cellBoard* nextBoard,
+	int begRow, int begCol, int endCol, int endRow){
+	cell rows[3][ROLLING_STRIP + 2];
+	cell sums[ROLLING_STRIP + 2];
+	int width = endCol - begCol + 2;
+	int leaving = 0;
+	const cell* in;
+	const cell* mid;
+	cell* out;
+	cell entering, window;
+	int row, j;
+	int liveCells = 0;
+
+	//the sums start with the rows above and at begRow, the one that
+	//leaves first is dead
+	memset(rows[0], 0, width * sizeof(cell));
+	memcpy(rows[1], ROW(currentBoard,begRow-1) + begCol - 1,
+		width * sizeof(cell));
+	memcpy(rows[2], ROW(currentBoard,begRow) + begCol - 1,
+		width * sizeof(cell));
+	for(j = 0; j < width; j++){
+		sums[j] = rows[1][j] + rows[2][j];
+	}
+	for(row = begRow; row < endRow; row++){
+		in = ROW(currentBoard,row+1) + begCol - 1;
+		mid = rows[(leaving + 2) % 3];
+		out = ROW(nextBoard,row) + begCol - 1;
+		//the row below takes the place of the row above in the sums
+		for(j = 0; j < width; j++){
+			entering = in[j];
+			sums[j] += entering - rows[leaving][j];
+			rows[leaving][j] = entering;
+		}
+		//the window holds the cell itself, 3 is a birth or a survivor with 2
+		//neighbors, 4 a survivor with 3
+		for(j = 1; j < width - 1; j++){
+			window = sums[j-1] + sums[j] + sums[j+1];
+			out[j] = (window == 3) | ((window == 4) & mid[j]);
+			liveCells += out[j];
+		}
+		leaving = (leaving + 1) % 3;
+	}
+	return liveCells;
+}
+
+/**
+ * Calculates the next iteration of a region of the board strip by strip,
+ * with rolling column sums
+ * @param currentBoard: the board for the current iteration
+ * @param nextBoard: the board for the next iteration
+ * @param begRow: The start row for the thread
+ * @param begCol: The start col for the thread
+ * @param endCol: One past the end col for the thread
+ * @param endRow: One past the end row for the thread
+ * @return: the number of live cells in the calculated part of nextBoard
+ */
+int calcNextRollingIteration(cellBoard* currentBoard, cellBoard* nextBoard,
+	int begRow, int begCol, int endCol, int endRow){
+	int col;
+	int stripEnd;
+	int liveCells = 0;
+
+	if(begRow >= endRow){
+		return 0;
+	}
+	for(col = begCol; col < endCol; col += ROLLING_STRIP){
+		stripEnd = col + ROLLING_STRIP < endCol ? col + ROLLING_STRIP :
+			endCol;
+		liveCells += calcStrip(currentBoard,nextBoard,begRow,col,stripEnd,
+			endRow);
+	}
+	return liveCells;
+}
@@ -0,0 +1,17 @@
+//rolling.h
+//Description: Rolling-sum step kernel for the board. The sum of each
+//             column over three rows is kept as the kernel walks down the
+//             region, adding the row that enters below and taking out the
+//             row that leaves above, and a window of three column sums
+//             slides across each row, so each cell of the board is read
+//             about once per generation instead of nine times.
+
+#ifndef ROLLING_H
+#define ROLLING_H
+
+#include "board.h"
+
+int calcNextRollingIteration(cellBoard* currentBoard, cellBoard* nextBoard,
+	int begRow, int begCol, int endCol, int endRow);
+
+#endif /* ROLLING_H */
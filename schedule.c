@@ -0,0 +1,155 @@
+//schedule.c
+//Description: Deques of the work-stealing scheduler. A deque only shrinks
+//             between two fills, so it is kept as a range of tile numbers
+//             packed in one 64-bit word. The owner takes the first tile and
+//             a thief the last one, each with a single compare and swap of
+//             the whole range, so no locks are needed.
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include "schedule.h"
+
+/**
+ * Packs the tiles first to end-1 into a deque range
+ * @param first: the first tile left
+ * @param end: one past the last tile left
+ * @return: the packed range
+ */
+static uint64_t packRange(uint32_t first, uint32_t end){
+	return (uint64_t) end << 32 | first;
+}
+
+/**
+ * Dynamically allocates a scheduler with empty deques
+ * @param numTiles: the number of tiles handed out each generation
+ * @param numThreads: the number of threads taking tiles
+ * @return: returns a pointer to the newly initialized scheduler
+ * @throws exit(1) if the scheduler can not be allocated
+ */
+tileSchedule* initializeTileSchedule(int numTiles, int numThreads){
+	tileSchedule* schedule;
+
+	schedule = (tileSchedule*) malloc(sizeof(tileSchedule));
+	if(schedule == NULL){
+		printf("%s", "error allocating tile schedule");
+		exit(1);
+	}
+	schedule->numTiles = numTiles;
+	schedule->numThreads = numThreads;
+	schedule->deques = (tileDeque*) aligned_alloc(sizeof(tileDeque),
+		2 * numThreads * sizeof(tileDeque));
+	if(schedule->deques == NULL){
+		printf("%s", "error allocating tile schedule");
+		exit(1);
+	}
+	memset(schedule->deques, 0, 2 * numThreads * sizeof(tileDeque));
+	return schedule;
+}
+
+/**
+ * Frees the memory allocated for a scheduler
+ * @param schedule: the scheduler to free, may be NULL
+ * @return nothing
+ */
+void freeTileSchedule(tileSchedule* schedule){
+	if(schedule != NULL){
+		free(schedule->deques);
+		free(schedule);
+	}
+}
+
+/**
+ * Returns a thread's deque for a generation
+ * @param schedule: the scheduler
+ * @param threadNum: the thread owning the deque
+ * @param phase: the generation, only its parity is used
+ * @return: the deque
+ */
+static tileDeque* dequeOf(tileSchedule* schedule, int threadNum, int phase){
+	return &schedule->deques[(phase & 1) * schedule->numThreads + threadNum];
+}
+
+/**
+ * Fills a thread's deque for a generation with its share of the tiles, a
+ * contiguous run so tiles taken one after the other are next to each
+ * other. Must be called by the owner before the barrier that ends the
+ * generation before it.
+ * @param schedule: the scheduler
+ * @param threadNum: the thread owning the deque
+ * @param phase: the generation the tiles are for
+ * @return nothing
+ */
+void fillTileDeque(tileSchedule* schedule, int threadNum, int phase){
+	long long numTiles = schedule->numTiles;
+	uint32_t first = numTiles * threadNum / schedule->numThreads;
+	uint32_t end = numTiles * (threadNum + 1) / schedule->numThreads;
+
+	__atomic_store_n(&dequeOf(schedule,threadNum,phase)->range,
+		packRange(first,end), __ATOMIC_RELAXED);
+}
+
+/**
+ * Takes the first tile of a deque
+ * @param deque: the deque
+ * @return: the tile, -1 if the deque is empty
+ */
+static int popTile(tileDeque* deque){
+	uint64_t range = __atomic_load_n(&deque->range, __ATOMIC_RELAXED);
+	uint32_t first;
+	uint32_t end;
+
+	do{
+		first = (uint32_t) range;
+		end = (uint32_t) (range >> 32);
+		if(first >= end){
+			return -1;
+		}
+	}while(!__atomic_compare_exchange_n(&deque->range, &range,
+		packRange(first+1,end), 0, __ATOMIC_ACQUIRE, __ATOMIC_RELAXED));
+	return first;
+}
+
+/**
+ * Takes the last tile of another thread's deque
+ * @param deque: the deque
+ * @return: the tile, -1 if the deque is empty
+ */
+static int stealTile(tileDeque* deque){
+	uint64_t range = __atomic_load_n(&deque->range, __ATOMIC_RELAXED);
+	uint32_t first;
+	uint32_t end;
+
+	do{
+		first = (uint32_t) range;
+		end = (uint32_t) (range >> 32);
+		if(first >= end){
+			return -1;
+		}
+	}while(!__atomic_compare_exchange_n(&deque->range, &range,
+		packRange(first,end-1), 0, __ATOMIC_ACQUIRE, __ATOMIC_RELAXED));
+	return end - 1;
+}
+
+/**
+ * Returns the next tile for a thread, from its own deque while it has
+ * tiles and stolen from the other threads' deques after that
+ * @param schedule: the scheduler
+ * @param threadNum: the thread asking for a tile
+ * @param phase: the generation being calculated
+ * @param stolen: set to 1 if the tile was stolen, 0 otherwise
+ * @return: the tile, -1 once every deque of the generation is empty
+ */
+int nextTile(tileSchedule* schedule, int threadNum, int phase, int* stolen){
+	int tile;
+	int i;
+
+	*stolen = 0;
+	tile = popTile(dequeOf(schedule,threadNum,phase));
+	for(i = 1; tile < 0 && i < schedule->numThreads; i++){
+		tile = stealTile(dequeOf(schedule,(threadNum + i) %
+			schedule->numThreads,phase));
+		*stolen = tile >= 0;
+	}
+	return tile;
+}
@@ -0,0 +1,34 @@
+//schedule.h
+//Description: Work-stealing scheduler of the tile partition. Each
+//             generation every thread's deque is filled with an even share
+//             of the tiles. A thread takes tiles from the bottom of its own
+//             deque and, once it is empty, steals from the top of the other
+//             threads' deques, so threads whose tiles are cheap help the
+//             ones whose tiles are busy. The deques of even and odd
+//             generations are kept apart, so a thread can fill its deque for
+//             the next generation while others still steal from this one.
+
+#ifndef SCHEDULE_H
+#define SCHEDULE_H
+
+#include <stdint.h>
+
+typedef struct tileDeque{
+	uint64_t range; // Tiles left, first one in the low half, end in the high
+} __attribute__((aligned(64))) tileDeque;
+
+typedef struct tileSchedule{
+	int numTiles; // Number of tiles handed out each generation
+	int numThreads; // Number of threads taking tiles
+	tileDeque* deques; // Two deques per thread, even then odd generations
+} tileSchedule;
+
+tileSchedule* initializeTileSchedule(int numTiles, int numThreads);
+
+void freeTileSchedule(tileSchedule* schedule);
+
+void fillTileDeque(tileSchedule* schedule, int threadNum, int phase);
+
+int nextTile(tileSchedule* schedule, int threadNum, int phase, int* stolen);
+
+#endif /* SCHEDULE_H */
@@ -0,0 +1,285 @@
+//simd.c
+//Description: Vectorized step kernel for the board. The halo of the board
+//             holds the neighbors past the edges for both wrap and nowrap,
+//             so every cell of a row is summed one vector at a time without
+//             branches. A tail shorter than a vector goes through rowScalar.
+
+#include "board.h"
+#include "simd.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define SIMD_X86 1
+#endif
+
+/**
+ * Scalar row function used when the CPU has no supported vector unit
+ * @param up: the row above
+ * @param mid: the row being calculated
+ * @param down: the row below
+ * @param out: the row of the next board
+ * @param beg: first column
+ * @param end: one past the last column
+ * @return: the number of live cells written to out
+ */
+static int rowScalar(const cell* up, const cell* mid, const cell* down,
+	cell* out, int beg, int end){
+	int j;
+	int liveCells = 0;
+	int sum;
+
+	for(j = beg; j < end; j++){
+		sum = up[j-1] + up[j] + up[j+1] + mid[j-1] + mid[j+1] +
+			down[j-1] + down[j] + down[j+1];
+		out[j] = sum == 3 || (sum == 2 && mid[j] == 1);
+		liveCells += out[j];
+	}
+	return liveCells;
+}
+
+#ifdef SIMD_X86
+
+/**
+ * SSE2 row function, 16 cells per instruction
+ * @param up: the row above
+ * @param mid: the row being calculated
+ * @param down: the row below
+ * @param out: the row of the next board
+ * @param beg: first column
+ * @param end: one past the last column
+ * @return: the number of live cells written to out
+ */
+__attribute__((target("sse2")))
+static int rowSse2(const cell* up, const cell* mid, const cell* down,
+	cell* out, int beg, int end){
+	const __m128i one = _mm_set1_epi8(1);
+	const __m128i two = _mm_set1_epi8(2);
+	const __m128i three = _mm_set1_epi8(3);
+	const __m128i zero = _mm_setzero_si128();
+	__m128i sum,alive,next;
+	__m128i count = _mm_setzero_si128();
+	int j;
+
+	for(j = beg; j + 16 <= end; j += 16){
+		sum = _mm_add_epi8(
+			_mm_add_epi8(
+				_mm_add_epi8(_mm_loadu_si128((const __m128i*) (up+j-1)),
+					_mm_loadu_si128((const __m128i*) (up+j))),
+				_mm_add_epi8(_mm_loadu_si128((const __m128i*) (up+j+1)),
+					_mm_loadu_si128((const __m128i*) (mid+j-1)))),
+			_mm_add_epi8(
+				_mm_add_epi8(_mm_loadu_si128((const __m128i*) (mid+j+1)),
+					_mm_loadu_si128((const __m128i*) (down+j-1))),
+				_mm_add_epi8(_mm_loadu_si128((const __m128i*) (down+j)),
+					_mm_loadu_si128((const __m128i*) (down+j+1)))));
+		alive = _mm_cmpeq_epi8(_mm_loadu_si128((const __m128i*) (mid+j)),
+			one);
+		next = _mm_or_si128(_mm_cmpeq_epi8(sum,three),
+			_mm_and_si128(_mm_cmpeq_epi8(sum,two),alive));
+		next = _mm_and_si128(next,one);
+		_mm_storeu_si128((__m128i*) (out+j),next);
+		//each half's bytes are summed into a 64-bit lane
+		count = _mm_add_epi64(count,_mm_sad_epu8(next,zero));
+	}
+	count = _mm_add_epi64(count,_mm_unpackhi_epi64(count,count));
+	return _mm_cvtsi128_si32(count) + rowScalar(up,mid,down,out,j,end);
+}
+
+/**
+ * AVX2 row function, 32 cells per instruction
+ * @param up: the row above
+ * @param mid: the row being calculated
+ * @param down: the row below
+ * @param out: the row of the next board
+ * @param beg: first column
+ * @param end: one past the last column
+ * @return: the number of live cells written to out
+ */
+__attribute__((target("avx2")))
+static int rowAvx2(const cell* up, const cell* mid, const cell* down,
+	cell* out, int beg, int end){
+	const __m256i one = _mm256_set1_epi8(1);
+	const __m256i two = _mm256_set1_epi8(2);
+	const __m256i three = _mm256_set1_epi8(3);
+	const __m256i zero = _mm256_setzero_si256();
+	__m256i sum,alive,next;
+	__m256i count = _mm256_setzero_si256();
+	__m128i half;
+	int j;
+
+	for(j = beg; j + 32 <= end; j += 32){
+		sum = _mm256_add_epi8(
+			_mm256_add_epi8(
+				_mm256_add_epi8(
+					_mm256_loadu_si256((const __m256i*) (up+j-1)),
+					_mm256_loadu_si256((const __m256i*) (up+j))),
+				_mm256_add_epi8(
+					_mm256_loadu_si256((const __m256i*) (up+j+1)),
+					_mm256_loadu_si256((const __m256i*) (mid+j-1)))),
+			_mm256_add_epi8(
+				_mm256_add_epi8(
+					_mm256_loadu_si256((const __m256i*) (mid+j+1)),
+					_mm256_loadu_si256((const __m256i*) (down+j-1))),
+				_mm256_add_epi8(
+					_mm256_loadu_si256((const __m256i*) (down+j)),
+					_mm256_loadu_si256((const __m256i*) (down+j+1)))));
+		alive = _mm256_cmpeq_epi8(
+			_mm256_loadu_si256((const __m256i*) (mid+j)),one);
+		next = _mm256_or_si256(_mm256_cmpeq_epi8(sum,three),
+			_mm256_and_si256(_mm256_cmpeq_epi8(sum,two),alive));
+		next = _mm256_and_si256(next,one);
+		_mm256_storeu_si256((__m256i*) (out+j),next);
+		//each quarter's bytes are summed into a 64-bit lane
+		count = _mm256_add_epi64(count,_mm256_sad_epu8(next,zero));
+	}
+	half = _mm_add_epi64(_mm256_castsi256_si128(count),
+		_mm256_extracti128_si256(count,1));
+	half = _mm_add_epi64(half,_mm_unpackhi_epi64(half,half));
+	return _mm_cvtsi128_si32(half) + rowScalar(up,mid,down,out,j,end);
+}
+
+/**
+ * AVX-512 row function, 64 cells per instruction. The byte instructions
+ * are those of AVX-512BW. The last vector of the row is masked, so rows
+ * and tiles narrower than a vector are not left to rowScalar.
+ * @param up: the row above
+ * @param mid: the row being calculated
+ * @param down: the row below
+ * @param out: the row of the next board
+ * @param beg: first column
+ * @param end: one past the last column
+ * @return: the number of live cells written to out
+ */
+__attribute__((target("avx512bw")))
+static int rowAvx512(const cell* up, const cell* mid, const cell* down,
+	cell* out, int beg, int end){
+	const __m512i one = _mm512_set1_epi8(1);
+	const __m512i two = _mm512_set1_epi8(2);
+	const __m512i three = _mm512_set1_epi8(3);
+	__m512i sum;
+	__mmask64 cols,alive,live;
+	int liveCells = 0;
+	int j;
+
+	for(j = beg; j < end; j += 64){
+		//the cells past end are masked off, neither read nor written
+		cols = end - j >= 64 ? ~(__mmask64) 0 :
+			((__mmask64) 1 << (end - j)) - 1;
+		sum = _mm512_add_epi8(
+			_mm512_add_epi8(
+				_mm512_add_epi8(_mm512_maskz_loadu_epi8(cols,up+j-1),
+					_mm512_maskz_loadu_epi8(cols,up+j)),
+				_mm512_add_epi8(_mm512_maskz_loadu_epi8(cols,up+j+1),
+					_mm512_maskz_loadu_epi8(cols,mid+j-1))),
+			_mm512_add_epi8(
+				_mm512_add_epi8(_mm512_maskz_loadu_epi8(cols,mid+j+1),
+					_mm512_maskz_loadu_epi8(cols,down+j-1)),
+				_mm512_add_epi8(_mm512_maskz_loadu_epi8(cols,down+j),
+					_mm512_maskz_loadu_epi8(cols,down+j+1))));
+		alive = _mm512_mask_cmpeq_epi8_mask(cols,
+			_mm512_maskz_loadu_epi8(cols,mid+j),one);
+		live = _mm512_mask_cmpeq_epi8_mask(cols,sum,three) |
+			(_mm512_cmpeq_epi8_mask(sum,two) & alive);
+		_mm512_mask_storeu_epi8(out+j,cols,_mm512_maskz_mov_epi8(live,one));
+		liveCells += __builtin_popcountll(live);
+	}
+	return liveCells;
+}
+
+#endif /* SIMD_X86 */
+
+/**
+ * Picks the row function of an instruction set. Nothing is stored, each
+ * caller keeps the row function it got and passes it to
+ * calcNextSimdIteration, so simulators using different instruction sets can
+ * run at once.
+ * @param isa: SIMD_AUTO to use the widest instruction set found with CPUID,
+ *             or a specific SIMD_ value
+ * @return: the row function, NULL if the requested instruction set is not
+ *          supported by this CPU
+ */
+simdRowFunc pickSimdKernel(int isa){
+	simdRowFunc chosen = rowScalar;
+
+#ifdef SIMD_X86
+	__builtin_cpu_init();
+	if(isa == SIMD_AUTO){
+		if(__builtin_cpu_supports("avx512bw")){
+			isa = SIMD_AVX512;
+		}
+		else if(__builtin_cpu_supports("avx2")){
+			isa = SIMD_AVX2;
+		}
+		else if(__builtin_cpu_supports("sse2")){
+			isa = SIMD_SSE2;
+		}
+		else{
+			isa = SIMD_SCALAR;
+		}
+	}
+	if((isa == SIMD_AVX512 && !__builtin_cpu_supports("avx512bw")) ||
+		(isa == SIMD_AVX2 && !__builtin_cpu_supports("avx2")) ||
+		(isa == SIMD_SSE2 && !__builtin_cpu_supports("sse2"))){
+		return NULL;
+	}
+	if(isa == SIMD_AVX512){
+		chosen = rowAvx512;
+	}
+	else if(isa == SIMD_AVX2){
+		chosen = rowAvx2;
+	}
+	else if(isa == SIMD_SSE2){
+		chosen = rowSse2;
+	}
+#else
+	if(isa != SIMD_AUTO && isa != SIMD_SCALAR){
+		return NULL;
+	}
+#endif
+	return chosen;
+}
+
+/**
+ * Returns the name of the instruction set of a row function
+ * @param kernel: a row function returned by pickSimdKernel
+ * @return: "avx512", "avx2", "sse2" or "scalar"
+ */
+const char* simdKernelName(simdRowFunc kernel){
+#ifdef SIMD_X86
+	if(kernel == rowAvx512){
+		return "avx512";
+	}
+	if(kernel == rowAvx2){
+		return "avx2";
+	}
+	if(kernel == rowSse2){
+		return "sse2";
+	}
+#endif
+	return "scalar";
+}
+
+/**
+ * Calculates the status of each cell of the slice for the next iteration
+ * with a vector row function. Takes the same arguments as
+ * calcNextIteration after the row function and produces the same cells.
+ * @param kernel: the row function, from pickSimdKernel
+ * @param currentBoard: the board for the current iteration
+ * @param nextBoard: the board for the next iteration
+ * @param begRow: The start row for the thread
+ * @param begCol: The start col for the thread
+ * @param endCol: One past the end col for the thread
+ * @param endRow: One past the end row for the thread
+ * @return: the number of live cells in the calculated part of nextBoard
+ */
+int calcNextSimdIteration(simdRowFunc kernel, cellBoard* currentBoard,
+	cellBoard* nextBoard, int begRow, int begCol,int endCol,int endRow){
+	int i;
+	int liveCells = 0;
+
+	for(i = begRow; i < endRow; i++){
+		liveCells += kernel(ROW(currentBoard,i-1),ROW(currentBoard,i),
+			ROW(currentBoard,i+1),ROW(nextBoard,i),begCol,endCol);
+	}
+	return liveCells;
+}
@@ -0,0 +1,30 @@
+//simd.h
+//Description: Vectorized step kernel for the board. The rule is applied
+//             to a whole row segment per instruction with SSE2, AVX2 or
+//             AVX-512BW, picked from what the CPU supports, with a scalar
+//             fallback on other machines. Each caller keeps the row function
+//             it picked, so nothing is shared between simulators.
+
+#ifndef SIMD_H
+#define SIMD_H
+
+#include "board.h"
+
+#define SIMD_AUTO 0 // Widest instruction set the CPU supports
+#define SIMD_SCALAR 1
+#define SIMD_SSE2 2
+#define SIMD_AVX2 3
+#define SIMD_AVX512 4
+
+//Computes the cells [beg,end) of a row and returns the live count
+typedef int (*simdRowFunc)(const cell* up, const cell* mid, const cell* down,
+	cell* out, int beg, int end);
+
+simdRowFunc pickSimdKernel(int isa);
+
+const char* simdKernelName(simdRowFunc kernel);
+
+int calcNextSimdIteration(simdRowFunc kernel, cellBoard* currentBoard,
+	cellBoard* nextBoard, int begRow, int begCol,int endCol,int endRow);
+
+#endif /* SIMD_H */
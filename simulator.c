@@ -0,0 +1,2545 @@
+//simulator.c
+//Description: Reentrant Game of Life simulator. The options, barrier,
+//             counts and worker pool are set up once by createSimulator and
+//             the boards by each loadSimulator. stepSimulator hands a job to
+//             the pool by publishing its number on the start flag; the
+//             workers sleep on that flag between jobs and every job ends at
+//             a barrier, after which only the calling thread touches the
+//             simulator until the next job.
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <unistd.h>
+#include <string.h>
+#include <limits.h>
+#include <time.h>
+#include <pthread.h>
+#include "pthread_barrier.h"
+#include "board.h"
+#include "bitboard.h"
+#include "simd.h"
+#include "lut.h"
+#include "rolling.h"
+#include "hashlife.h"
+#include "tiles.h"
+#include "schedule.h"
+#include "spinbarrier.h"
+#include "checkpoint.h"
+#include "topology.h"
+#include "simulator.h"
+
+#define CACHE_LINE 64 // Bytes per cache line
+#define JOB_STEP 0 // Job advancing the board jobSteps generations
+#define JOB_TOUCH 1 // Job clearing each thread's rows of new boards (numa)
+#define TRACE_COMPUTE 0 // Trace event of a thread calculating its slice
+#define TRACE_BARRIER 1 // Trace event of a thread waiting at the barrier
+#define TRACE_NEIGHBORS 2 // Trace event of a thread waiting for neighbors
+
+typedef struct liveCountSlot{
+	int liveCells; // Live cells the thread produced this generation
+	long long tilesProcessed; // Tiles the thread recalculated this generation
+	long long liveTotal; // Live cells summed over the generations calculated
+	uint64_t hash; // Hash of the cells the thread produced, when detecting
+} __attribute__((aligned(CACHE_LINE))) liveCountSlot;
+
+typedef struct cycleEntry{
+	uint64_t hash; // Hash of the board of a generation
+	long long liveCount; // Live cells in the board of the generation
+} cycleEntry;
+
+typedef struct traceEvent{
+	long long begin; // Monotonic time the phase began, in nanoseconds
+	long long end; // Monotonic time the phase ended, in nanoseconds
+	int type; // One of the TRACE_ values
+	int generation; // Generation the thread calculated from
+} traceEvent;
+
+typedef struct threadProfile{
+	long long computeTime; // Nanoseconds spent calculating the slice
+	long long barrierTime; // Nanoseconds spent waiting at the barrier
+	long long neighborTime; // Nanoseconds spent waiting for the neighbors
+	long long slowestStep; // Nanoseconds of the longest step calculated
+	long long generations; // Generations calculated
+	traceEvent* events; // Every phase, PROFILE_TRACE only
+	int numEvents; // Number of events
+	int eventCapacity; // Events the array can hold
+} __attribute__((aligned(CACHE_LINE))) threadProfile;
+
+typedef struct threadArg{
+	simulator* sim; // Simulator the thread belongs to
+	int maxRow; // End row of board
+	int maxCol; // End col of board
+	int begCol; // Beginning col of board for thread
+	int begRow; // Beginning row of board for thread
+	int endCol; // End col of board for thread
+	int endRow; // End row of board for thread
+	int wrap; // wrap argument
+	int threadNum;
+	int numThreads;
+	int kernel; // Step kernel
+	simdRowFunc simdRow; // Row function when kernel is simd
+	cellBoard* currentBoard; // Pointer to current board
+	cellBoard* nextBoard; // Pointer to next board
+	bitBoard* currentBits; // Current board when kernel is bitpack
+	bitBoard* nextBits; // Next board when kernel is bitpack
+	int generation; // Generation held by the current board
+	tileMap* tiles; // Active region, NULL to recalculate every cell
+	int* regionLive; // Live cells of each tile of the slice
+	tileSchedule* schedule; // Tiles to take, tile partition only, else NULL
+	int tileSize; // Rows and columns of cells per tile of the tile partition
+	long long tilesDone; // Tiles the thread calculated (tile partition)
+	long long steals; // Tiles the thread stole (tile partition)
+	int depth; // Generations calculated between barriers
+	int rowBand; // 1 if the window's halo is above and below the band
+	int winRow; // Board row of row 0 of the private window (depth above 1)
+	int winCol; // Board col of col 0 of the private window (depth above 1)
+	cellBoard* localCurrent; // Private window of the current generation
+	cellBoard* localNext; // Private window of the next generation
+	int phase; // Steps calculated so far, picks the slots and deques used
+	int pipeline; // 1 to wait for the neighbors only instead of a barrier
+	int* neighbors; // Threads whose cells this one reads (pipeline)
+	int numNeighbors; // Number of neighbors
+} threadArg;
+
+typedef struct poolWorker{
+	simulator* sim; // Simulator the worker belongs to
+	int threadNum; // Thread number of the worker, 1 and up
+} poolWorker;
+
+struct simulator{
+	spinBarrier spinSync; // Barrier when the barrier is spin
+	progressFlag start; // Number of jobs handed to the pool
+	pthread_barrier_t barrier; // Barrier when the barrier is pthread
+	simOptions opts; // Options the simulator was created with
+	simdRowFunc simdRow; // Row function of the simd kernel, NULL otherwise
+	int spinRounds; // Spin rounds before a waiting thread sleeps
+	int numWorkers; // Threads created for the pool
+	unsigned int jobs; // Jobs handed to the pool
+	int jobKind; // JOB_STEP or JOB_TOUCH
+	int jobSteps; // Generations of the job being run
+	int quit; // Set to end the workers with the next job
+	int loaded; // 1 once a board was loaded
+	int rows; // Number of rows in the grid
+	int cols; // Number of columns in the grid
+	int generation; // Generation held by the current board
+	long long liveCount; // Live cells in the current board
+	long long totalLiveCount; // Live cells summed over every generation
+	long long tilesProcessed; // Tiles recalculated in the last step
+	long long totalTilesProcessed; // Tiles recalculated since the load
+	int detecting; // 1 while the job hashes every generation it calculates
+	int stopGeneration; // Thread generation the job stops at, a cycle found
+	uint64_t hash; // Hash of the current board, while detecting
+	uint64_t* rowKeys; // Hash key of each row, NULL unless cycleHistory
+	uint64_t* colKeys; // Hash key of each column, or word for bitpack
+	cycleEntry* history; // The last cycleHistory generations, a ring
+	int historyCount; // Entries of history filled
+	int historyNext; // Entry of history written next
+	int candidatePeriod; // Period of a hash match not yet compared, or 0
+	checkpoint* cycleStart; // Board copied to compare a period later, or NULL
+	int period; // Generations between repeats of the board, 0 if none found
+	int stableGeneration; // Generation the repeat was confirmed from
+	long long cycleLiveSum; // Live cells summed over one period
+	liveCountSlot* slots; // Two slots per thread, even and odd steps
+	progressFlag* progress; // Steps each thread completed, when pipelined
+	cellBoard* currentBoard; // Byte grid of the current generation
+	cellBoard* nextBoard; // Byte grid of the next generation
+	bitBoard* currentBits; // Current board when kernel is bitpack
+	bitBoard* nextBits; // Next board when kernel is bitpack
+	hashlife* hl; // The board when the engine is hashlife
+	tileMap* tiles; // Active region, NULL to recalculate every cell
+	tileSchedule* schedule; // Scheduler of the tile partition, else NULL
+	threadArg* threadInput; // Arguments of each thread of the pool
+	threadProfile* profiles; // Phases of each thread, NULL if not profiled
+	int* cpus; // CPU each thread is pinned to, NULL unless numa
+	int* nodes; // NUMA node of each thread's CPU, NULL unless numa
+	long long profileStart; // Monotonic time the profiles were cleared
+	poolWorker* workers; // Arguments of the threads created for the pool
+	pthread_t* workerID; // Threads created for the pool, numThreads-1
+	const char* error; // Why the last call failed
+};
+
+/**
+ * Returns the digits of the largest thread number, the width thread numbers
+ * are printed with so the lines of every thread line up
+ * @param numThreads: The total number of threads
+ * @return: the number of digits of numThreads-1, 0 for one thread
+ */
+static int threadNumWidth(int numThreads){
+	int num = numThreads-1;
+	int width = 0;
+
+	while(num != 0){
+		num = num / 10;
+		width++;
+	}
+	return width;
+}
+
+/**
+ * Prints the partition information for a thread
+ * @param threadNum: number of the thread being printed 
+ * @param numThreads: The total number of threads
+ * @param begRow: The start row for the thread
+ * @param begCol: The start col for the thread
+ * @param endRow: The end row for the thread
+ * @param endCol: The end col for the thread
+ * @param rowMax: The number of rows in the grid
+ * @param colMax: The number of columns in the grid
+ * @return nothing
+ */
+static void printPartition(int threadNum,int numThreads ,int begRow,
+		int endRow, int begCol,int endCol,int rowMax,int colMax){
+
+	int num,rowForm,colForm,threadNumForm;
+	colForm = 0;
+	rowForm = 0;
+	threadNumForm = threadNumWidth(numThreads);
+	num = rowMax+1;
+   	while(num != 0) {
+      	num = num / 10;
+      	rowForm++;
+   	}
+   	num = colMax+1;
+   	while(num != 0) {
+      	num = num / 10;
+      	colForm++;
+   	}
+
+	printf("Thread %*d: Rows: %*d:%*d (%*d) Cols: %*d:%*d (%*d)\n",
+		threadNumForm,threadNum,rowForm,begRow,rowForm,endRow,rowForm,
+		endRow-begRow+1,colForm,begCol,colForm,endCol,colForm,endCol-begCol+1);
+	fflush(stdout);
+}
+
+/**
+ * Prints the work a thread did with tile partitioning, which has no fixed
+ * range of rows and columns
+ * @param threadNum: number of the thread being printed 
+ * @param numThreads: The total number of threads
+ * @param tilesDone: The tiles the thread calculated during the simulation
+ * @param steals: The tiles the thread stole from other threads
+ * @return nothing
+ */
+static void printTileSchedule(int threadNum, int numThreads,
+	long long tilesDone, long long steals){
+	int threadNumForm = threadNumWidth(numThreads);
+
+	printf("Thread %*d: Tiles: %lld Steals: %lld\n",threadNumForm,threadNum,
+		tilesDone,steals);
+	fflush(stdout);
+}
+
+/**
+ * Prints where a profiled thread's time went: calculating its slice and
+ * waiting at the barrier or for its neighbors, the share of its time spent
+ * calculating, the generations it calculated and its slowest step
+ * @param threadNum: number of the thread being printed
+ * @param numThreads: The total number of threads
+ * @param profile: the thread's profile
+ * @return nothing
+ */
+static void printThreadProfile(int threadNum, int numThreads,
+	const threadProfile* profile){
+	int threadNumForm = threadNumWidth(numThreads);
+	long long total = profile->computeTime + profile->barrierTime +
+		profile->neighborTime;
+
+	printf("Thread %*d: Compute: %0.3f ms (%0.1f%%) Barrier: %0.3f ms "
+		"Neighbors: %0.3f ms Generations: %lld Slowest step: %0.3f ms\n",
+		threadNumForm,threadNum,profile->computeTime / 1e6,
+		total > 0 ? 100.0 * profile->computeTime / total : 0.0,
+		profile->barrierTime / 1e6,profile->neighborTime / 1e6,
+		profile->generations,profile->slowestStep / 1e6);
+	fflush(stdout);
+}
+
+/**
+ * Prints the CPU and NUMA node a thread is pinned to
+ * @param threadNum: number of the thread being printed
+ * @param numThreads: The total number of threads
+ * @param cpu: the thread's CPU
+ * @param node: the node of the CPU
+ * @return nothing
+ */
+static void printThreadCpu(int threadNum, int numThreads, int cpu,
+	int node){
+	int threadNumForm = threadNumWidth(numThreads);
+
+	printf("Thread %*d: CPU: %d Node: %d\n",threadNumForm,threadNum,cpu,
+		node);
+	fflush(stdout);
+}
+
+/**
+ * Prints the contents of a board on screen
+ * @param board: the board to be printed on screen
+ * @return nothing
+ * @throws exit(1) if the row buffer can not be allocated
+ */
+static void displayBoard(cellBoard* board){
+	char* line;
+	int i;
+	int j;
+
+	line = (char*) malloc(board->cols + 1);
+	if(line == NULL){
+		printf("%s", "error allocating board");
+		exit(1);
+	}
+	//build each row in a buffer and print it with one call
+	for(i = 0; i < board->rows; i++){
+		for(j = 0; j < board->cols; j++){
+			line[j] = CELL(board,i,j) == 0 ? '-' : '@';
+		}
+		line[board->cols] = '\n';
+		fwrite(line, 1, board->cols + 1, stdout);
+	}
+	free(line);
+}
+
+/**
+ * Calculates the status of each cell for the next iteration and assigns the
+ * corresponding values in the board for the next iteration. The halo around
+ * the grid is dead for nowrap and holds the opposite edge for wrap, so the
+ * same reads work for both and need no bounds checks. The rule is applied
+ * with compares instead of branches on the cell and its neighbors, so the
+ * loop over a row is vectorized whatever the board looks like.
+ * @param currentBoard: pointer to the grid for the current iteration
+ * @param nextBoard: pointer to the grid for the next iteration
+ * @param begRow: The start row for the thread
+ * @param begCol: The start col for the thread
+ * @param endRow: The end row for the thread
+ * @param endCol: The end col for the thread
+ * @return: the number of live cells in the calculated part of nextBoard
+ */
+__attribute__((optimize("tree-vectorize","vect-cost-model=dynamic")))
+static int calcNextIteration(cellBoard* currentBoard, cellBoard* nextBoard,
+		int begRow, int begCol,int endCol,int endRow){
+	const cell* up;
+	const cell* mid;
+	const cell* down;
+	cell* out;
+	cell neighbors;
+	int i;
+	int j;
+	int liveCells = 0;
+
+	for(i = begRow; i < endRow; i++){
+		up = ROW(currentBoard,i-1);
+		mid = ROW(currentBoard,i);
+		down = ROW(currentBoard,i+1);
+		out = ROW(nextBoard,i);
+		for(j = begCol; j < endCol; j++){
+			neighbors = up[j-1] + up[j] + up[j+1] + mid[j-1] + mid[j+1] +
+				down[j-1] + down[j] + down[j+1];
+			//born with 3 neighbors, survives with 2 or 3
+			out[j] = (neighbors == 3) | ((neighbors == 2) & mid[j]);
+			liveCells += out[j];
+		}
+	}
+	return liveCells;
+}
+
+/**
+ * Gives the band of one part when size rows or columns are spread as evenly
+ * as they can be across numParts parts, the first ones getting one more
+ * when they do not divide evenly. Parts past the last row or column get an
+ * empty band, end below beg.
+ * @param numParts: the number of parts
+ * @param size: the number of rows or columns split
+ * @param part: the part, 0 to numParts-1
+ * @param beg: set to the first row or column of the part
+ * @param end: set to the last row or column of the part
+ * @return nothing
+ */
+void partitionBand(int numParts, int size, int part, int* beg, int* end){
+	int numGetMaxPart;
+	int maxPart;
+
+	numGetMaxPart = size % numParts;
+	maxPart = size / numParts;
+	if(numGetMaxPart != 0){
+		maxPart++;
+	}
+	else{
+		numGetMaxPart = numParts;
+	}
+	if(part < numGetMaxPart){
+		*beg = maxPart*part;
+		*end = maxPart*(part+1)-1;
+	}
+	else{
+		*beg = maxPart*numGetMaxPart + (maxPart-1)*(part-numGetMaxPart);
+		*end = maxPart*numGetMaxPart+(maxPart-1)*(part+1-numGetMaxPart)-1;
+	}
+}
+
+/**
+ * Partitions the boards into sections based on row or col partitioning.
+ * This is based on the number of threads so the number of rows are columns
+ * are spread as evenly as they can be across the threads. With tile
+ * partitioning every thread may calculate any part of the board, so each
+ * one is given the whole board.
+ * @param numThreads: The number of threads created
+ * @param row: The number of rows in the grid
+ * @param col: The number of columns in the grid
+ * @param partType: The type of partition, one of the PARTITION_ values
+ * @param threadInput: The array of thread inputs
+ * @return nothing
+ */
+static void partition(int numThreads,int row,int col,int partType,
+	threadArg* threadInput){
+	int i;
+	int begRowCol;
+	int endRowCol;
+
+	if(partType == PARTITION_TILE){
+		for(i = 0; i < numThreads; i++){
+			threadInput[i].begRow = 0;
+			threadInput[i].endRow = row-1;
+			threadInput[i].begCol = 0;
+			threadInput[i].endCol = col-1;
+		}
+		return;
+	}
+	for(i = 0; i < numThreads;i++){
+		partitionBand(numThreads,partType == PARTITION_ROW ? row : col,i,
+			&begRowCol,&endRowCol);
+		if(partType == PARTITION_ROW){
+			threadInput[i].begRow = begRowCol;
+			threadInput[i].endRow = endRowCol;
+			threadInput[i].begCol = 0;
+			threadInput[i].endCol = col-1;
+		}
+		else{
+			threadInput[i].begCol = begRowCol;
+			threadInput[i].endCol = endRowCol;
+			threadInput[i].begRow = 0;
+			threadInput[i].endRow = row-1;
+		}
+	}
+}
+
+/**
+ * Calculates the next iteration of a region of a byte grid with the kernel
+ * selected for the run
+ * @param arg: the thread's arguments, with the kernel, KERNEL_SCALAR,
+ *             KERNEL_SIMD, KERNEL_LUT or KERNEL_ROLLING, and the simd row
+ *             function
+ * @param currentBoard: pointer to the grid for the current iteration
+ * @param nextBoard: pointer to the grid for the next iteration
+ * @param begRow: The start row of the region
+ * @param begCol: The start col of the region
+ * @param endCol: One past the end col of the region
+ * @param endRow: One past the end row of the region
+ * @return: the number of live cells in the region of nextBoard
+ */
+static int calcRegion(const threadArg* arg, cellBoard* currentBoard,
+	cellBoard* nextBoard, int begRow, int begCol, int endCol, int endRow){
+	int kernel = arg->kernel;
+
+	if(kernel == KERNEL_SIMD){
+		return calcNextSimdIteration(arg->simdRow,currentBoard,nextBoard,
+			begRow,begCol,endCol,endRow);
+	}
+	if(kernel == KERNEL_LUT){
+		return calcNextLutIteration(currentBoard,nextBoard,
+			begRow,begCol,endCol,endRow);
+	}
+	if(kernel == KERNEL_ROLLING){
+		return calcNextRollingIteration(currentBoard,nextBoard,
+			begRow,begCol,endCol,endRow);
+	}
+	return calcNextIteration(currentBoard,nextBoard,
+		begRow,begCol,endCol,endRow);
+}
+
+/**
+ * Returns the live count slot a thread stores the step it is calculating
+ * in. Even and odd steps use different slots, so a thread can store the
+ * next step while the last one is still being summed.
+ * @param arg: the thread's arguments
+ * @return: the slot
+ */
+static liveCountSlot* threadSlot(threadArg* arg){
+	return &arg->sim->slots[2 * arg->threadNum + (arg->phase & 1)];
+}
+
+/**
+ * Mixes a number into a 64 bit hash key, the finalizer of splitmix64
+ * @param x: the number
+ * @return: the key
+ */
+static uint64_t mixKey(uint64_t x){
+	x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ULL;
+	x = (x ^ (x >> 27)) * 0x94d049bb133111ebULL;
+	return x ^ (x >> 31);
+}
+
+/**
+ * Hashes a region of a byte grid for cycle detection. Each live cell adds
+ * the key of its column to the sum of its row, and each row's sum is
+ * multiplied by the key of the row, so the hashes of regions that do not
+ * overlap add up to the hash of the board however the threads split it.
+ * The loop has no branch on the cells.
+ * @param sim: the simulator, with the keys
+ * @param board: the board
+ * @param begRow: The start row
+ * @param begCol: The start col
+ * @param endCol: One past the end col
+ * @param endRow: One past the end row
+ * @return: the hash of the region
+ */
+static uint64_t hashCells(const simulator* sim, const cellBoard* board,
+	int begRow, int begCol, int endCol, int endRow){
+	const uint64_t* colKeys = sim->colKeys;
+	const cell* cells;
+	uint64_t hash = 0;
+	uint64_t rowSum;
+	int row, col;
+
+	for(row = begRow; row < endRow; row++){
+		cells = ROW(board,row);
+		rowSum = 0;
+		for(col = begCol; col < endCol; col++){
+			rowSum += colKeys[col] & -(uint64_t) cells[col];
+		}
+		hash += sim->rowKeys[row] * rowSum;
+	}
+	return hash;
+}
+
+/**
+ * Hashes words of rows of a bit board for cycle detection, the same way as
+ * hashCells with each word mixed with its key instead of each cell
+ * @param sim: the simulator, with the keys
+ * @param board: the board
+ * @param begRow: The start row
+ * @param endRow: One past the end row
+ * @param begWord: The start word of each row
+ * @param endWord: One past the end word of each row
+ * @return: the hash of the words
+ */
+static uint64_t hashWords(const simulator* sim, const bitBoard* board,
+	int begRow, int endRow, int begWord, int endWord){
+	const uint64_t* words;
+	uint64_t hash = 0;
+	uint64_t rowSum;
+	int row, word;
+
+	for(row = begRow; row < endRow; row++){
+		words = board->bits + (size_t) row * board->words;
+		rowSum = 0;
+		for(word = begWord; word < endWord; word++){
+			rowSum += mixKey(words[word] + sim->colKeys[word]);
+		}
+		hash += sim->rowKeys[row] * rowSum;
+	}
+	return hash;
+}
+
+/**
+ * Calculates the next iteration of the active tiles of a thread's slice and
+ * keeps the live count of the others. A tile shared with another slice is
+ * split, each thread calculates and counts the live cells of its own part
+ * of it. Stores the number of tiles recalculated in the thread's slot, a
+ * split tile counted only by the slice holding its first cell.
+ * @param arg: the thread's arguments
+ * @return: the number of live cells in the slice of nextBoard
+ */
+static int calcActiveTiles(threadArg* arg){
+	tileMap* tiles = arg->tiles;
+	int size = tiles->tileSize;
+	int tileRow;
+	int tileCol;
+	int begRow;
+	int begCol;
+	int endCol;
+	int endRow;
+	int region = 0;
+	int processed = 0;
+	int liveCells = 0;
+
+	for(tileRow = arg->begRow / size; tileRow <= arg->endRow / size;
+		tileRow++){
+		begRow = tileRow * size > arg->begRow ? tileRow * size : arg->begRow;
+		endRow = (tileRow + 1) * size < arg->endRow + 1 ?
+			(tileRow + 1) * size : arg->endRow + 1;
+		for(tileCol = arg->begCol / size; tileCol <= arg->endCol / size;
+			tileCol++){
+			begCol = tileCol * size > arg->begCol ? tileCol * size :
+				arg->begCol;
+			endCol = (tileCol + 1) * size < arg->endCol + 1 ?
+				(tileCol + 1) * size : arg->endCol + 1;
+			if(tileActive(tiles,tileRow,tileCol,arg->generation)){
+				arg->regionLive[region] = calcRegion(arg,
+					arg->currentBoard,arg->nextBoard,begRow,begCol,endCol,
+					endRow);
+				if(regionChanged(arg->currentBoard,arg->nextBoard,begRow,
+					begCol,endCol,endRow)){
+					markTileChanged(tiles,tileRow,tileCol,
+						arg->generation + 1);
+				}
+				processed += begRow == tileRow * size &&
+					begCol == tileCol * size;
+			}
+			liveCells += arg->regionLive[region];
+			region++;
+		}
+	}
+	threadSlot(arg)->tilesProcessed = processed;
+	return liveCells;
+}
+
+/**
+ * Calculates the next iteration of the tiles a thread takes from the tile
+ * partition's scheduler until every deque is empty. For the byte grid a tile
+ * is a tile of the active region and is only recalculated if active, for
+ * bitpack it is a band of tileSize whole rows. Refreshes the halo cells
+ * copied from each tile it took. Stores the number of tiles recalculated in
+ * the thread's slot, and when detecting cycles the hash of its tiles.
+ * @param arg: the thread's arguments
+ * @return: the number of live cells in the tiles the thread took
+ */
+static int calcScheduledTiles(threadArg* arg){
+	tileMap* tiles = arg->tiles;
+	int tile;
+	int stolen;
+	int tileRow;
+	int tileCol;
+	int begRow;
+	int begCol;
+	int endCol;
+	int endRow;
+	int processed = 0;
+	int liveCells = 0;
+	uint64_t hash = 0;
+
+	while((tile = nextTile(arg->schedule,arg->threadNum,arg->phase,
+		&stolen)) >= 0){
+		arg->steals += stolen;
+		if(tiles == NULL){
+			begRow = tile * arg->tileSize;
+			endRow = begRow + arg->tileSize < arg->maxRow ?
+				begRow + arg->tileSize : arg->maxRow;
+			liveCells += calcNextBitIteration(arg->currentBits,
+				arg->nextBits,begRow,endRow,0,arg->currentBits->words,
+				arg->wrap);
+			if(arg->sim->detecting){
+				hash += hashWords(arg->sim,arg->nextBits,begRow,endRow,0,
+					arg->nextBits->words);
+			}
+			processed++;
+			continue;
+		}
+		tileRow = tile / tiles->tileCols;
+		tileCol = tile % tiles->tileCols;
+		begRow = tileRow * tiles->tileSize;
+		begCol = tileCol * tiles->tileSize;
+		endRow = begRow + tiles->tileSize < arg->maxRow ?
+			begRow + tiles->tileSize : arg->maxRow;
+		endCol = begCol + tiles->tileSize < arg->maxCol ?
+			begCol + tiles->tileSize : arg->maxCol;
+		if(tileActive(tiles,tileRow,tileCol,arg->generation)){
+			tiles->live[tile] = calcRegion(arg,arg->currentBoard,
+				arg->nextBoard,begRow,begCol,endCol,endRow);
+			if(regionChanged(arg->currentBoard,arg->nextBoard,begRow,begCol,
+				endCol,endRow)){
+				markTileChanged(tiles,tileRow,tileCol,arg->generation + 1);
+			}
+			processed++;
+		}
+		if(arg->wrap){
+			refreshHaloRegion(arg->nextBoard,begRow,begCol,endCol,endRow);
+		}
+		if(arg->sim->detecting){
+			hash += hashCells(arg->sim,arg->nextBoard,begRow,begCol,endCol,
+				endRow);
+		}
+		liveCells += tiles->live[tile];
+	}
+	arg->tilesDone += processed;
+	threadSlot(arg)->tilesProcessed = processed;
+	threadSlot(arg)->hash = hash;
+	return liveCells;
+}
+
+/**
+ * Calculates the next iteration of a thread's slice with the kernel selected
+ * for the run and stores the slice's live count in the thread's slot. With
+ * an active region only the tiles near a change are recalculated, with tile
+ * partitioning the thread takes tiles until none are left. The
+ * bitpack kernel works on whole words, so a word belongs to the thread
+ * whose column range holds the first cell of the word. On a wrapping byte
+ * grid the thread refreshes the halo cells copied from its slice. When
+ * detecting cycles the slice of the next board is hashed too.
+ * @param arg: the thread's arguments
+ * @return nothing
+ */
+static void calcSlice(threadArg* arg){
+	int liveCells;
+
+	if(arg->schedule != NULL){
+		liveCells = calcScheduledTiles(arg);
+	}
+	else if(arg->kernel == KERNEL_BITPACK){
+		liveCells = calcNextBitIteration(arg->currentBits,arg->nextBits,
+			arg->begRow,arg->endRow+1,
+			(arg->begCol + BITS_PER_WORD - 1) / BITS_PER_WORD,
+			arg->endCol / BITS_PER_WORD + 1,arg->wrap);
+	}
+	else if(arg->tiles != NULL){
+		liveCells = calcActiveTiles(arg);
+	}
+	else{
+		liveCells = calcRegion(arg,arg->currentBoard,arg->nextBoard,
+			arg->begRow,arg->begCol,arg->endCol+1,arg->endRow+1);
+	}
+	if(arg->wrap && arg->nextBoard != NULL && arg->schedule == NULL){
+		refreshHaloRegion(arg->nextBoard,arg->begRow,arg->begCol,
+			arg->endCol+1,arg->endRow+1);
+	}
+	if(arg->sim->detecting && arg->schedule == NULL){
+		threadSlot(arg)->hash = arg->kernel == KERNEL_BITPACK ?
+			hashWords(arg->sim,arg->nextBits,arg->begRow,arg->endRow+1,
+			(arg->begCol + BITS_PER_WORD - 1) / BITS_PER_WORD,
+			arg->endCol / BITS_PER_WORD + 1) :
+			hashCells(arg->sim,arg->nextBoard,arg->begRow,arg->begCol,
+			arg->endCol+1,arg->endRow+1);
+	}
+	threadSlot(arg)->liveCells = liveCells;
+	threadSlot(arg)->liveTotal = liveCells;
+}
+
+/**
+ * Copies a row of the board into a row of a private window. Window column j
+ * holds board column winCol+j, which wraps around if wrap and is left dead
+ * if it is outside of the board otherwise.
+ * @param window: the private window
+ * @param winRow: the row of the window to fill
+ * @param board: the shared board
+ * @param row: the row of the board to copy
+ * @param winCol: the board column of window column 0
+ * @param wrap: 0 for nowrap 1 for wrap
+ * @return nothing
+ */
+static void copyWindowRow(cellBoard* window, int winRow,
+	const cellBoard* board, int row, int winCol, int wrap){
+	int j = 0;
+	int col;
+	int length;
+
+	while(j < window->cols){
+		col = winCol + j;
+		if(wrap){
+			col = (col % board->cols + board->cols) % board->cols;
+		}
+		else if(col < 0){
+			j = -winCol;
+			continue;
+		}
+		else if(col >= board->cols){
+			break;
+		}
+		length = window->cols - j < board->cols - col ?
+			window->cols - j : board->cols - col;
+		memcpy(ROW(window,winRow) + j, ROW(board,row) + col,
+			length * sizeof(cell));
+		j += length;
+	}
+}
+
+/**
+ * Calculates several generations of a thread's band without synchronizing.
+ * The band and a depth cell deep halo on both sides of it are copied into
+ * the thread's private window, which is advanced one generation at a time,
+ * each calculating one cell less of the halo, until only the band is left
+ * to write to the shared next board. Cells outside of a nowrap board are
+ * never calculated and stay dead. Stores the live count of the band in the
+ * last generation and summed over all of them in the thread's slot and
+ * refreshes the halo cells copied from the band.
+ * @param arg: the thread's arguments
+ * @param steps: the number of generations to calculate, at most depth
+ * @return nothing
+ */
+static void calcTemporalBlock(threadArg* arg, int steps){
+	cellBoard* swapTemp;
+	int rowBand = arg->rowBand;
+	int bandBeg = rowBand ? arg->begRow - arg->winRow :
+		arg->begCol - arg->winCol;
+	int bandEnd = rowBand ? arg->endRow + 1 - arg->winRow :
+		arg->endCol + 1 - arg->winCol;
+	int lowest = rowBand ? -arg->winRow : -arg->winCol;
+	int highest = rowBand ? arg->maxRow - arg->winRow :
+		arg->maxCol - arg->winCol;
+	int across = rowBand ? arg->maxCol : arg->maxRow;
+	int i;
+	int beg;
+	int end;
+	int liveCells = 0;
+	long long liveTotal = 0;
+
+	if(bandBeg >= bandEnd){
+		threadSlot(arg)->liveCells = 0;
+		threadSlot(arg)->liveTotal = 0;
+		return;
+	}
+	for(i = 0; i < arg->localCurrent->rows; i++){
+		if(arg->wrap){
+			copyWindowRow(arg->localCurrent,i,arg->currentBoard,
+				((arg->winRow + i) % arg->maxRow + arg->maxRow) %
+				arg->maxRow,arg->winCol,1);
+		}
+		else if(arg->winRow + i >= 0 && arg->winRow + i < arg->maxRow){
+			copyWindowRow(arg->localCurrent,i,arg->currentBoard,
+				arg->winRow + i,arg->winCol,0);
+		}
+	}
+	for(i = 0; i < steps; i++){
+		if(arg->wrap){
+			//only the halo across the band is read
+			refreshHalo(arg->localCurrent);
+		}
+		beg = bandBeg - (steps - 1 - i);
+		end = bandEnd + (steps - 1 - i);
+		if(!arg->wrap){
+			beg = beg > lowest ? beg : lowest;
+			end = end < highest ? end : highest;
+		}
+		if(rowBand){
+			calcRegion(arg,arg->localCurrent,arg->localNext,
+				beg,0,across,bandBeg);
+			liveCells = calcRegion(arg,arg->localCurrent,
+				arg->localNext,bandBeg,0,across,bandEnd);
+			calcRegion(arg,arg->localCurrent,arg->localNext,
+				bandEnd,0,across,end);
+		}
+		else{
+			calcRegion(arg,arg->localCurrent,arg->localNext,
+				0,beg,bandBeg,across);
+			liveCells = calcRegion(arg,arg->localCurrent,
+				arg->localNext,0,bandBeg,bandEnd,across);
+			calcRegion(arg,arg->localCurrent,arg->localNext,
+				0,bandEnd,end,across);
+		}
+		liveTotal += liveCells;
+		swapTemp = arg->localCurrent;
+		arg->localCurrent = arg->localNext;
+		arg->localNext = swapTemp;
+	}
+	for(i = arg->begRow; i <= arg->endRow; i++){
+		memcpy(ROW(arg->nextBoard,i) + arg->begCol,
+			ROW(arg->localCurrent,i - arg->winRow) + arg->begCol -
+			arg->winCol,(arg->endCol - arg->begCol + 1) * sizeof(cell));
+	}
+	if(arg->wrap){
+		refreshHaloRegion(arg->nextBoard,arg->begRow,arg->begCol,
+			arg->endCol+1,arg->endRow+1);
+	}
+	threadSlot(arg)->liveCells = liveCells;
+	threadSlot(arg)->liveTotal = liveTotal;
+}
+
+/**
+ * Gives every thread its private windows for temporal blocking, the band
+ * of the partition and depth cells on both sides of it across the band and
+ * the whole board along it. Must be called after partition.
+ * @param numThreads: The number of threads created
+ * @param threadInput: The array of thread inputs
+ * @param partType: PARTITION_ROW or PARTITION_COL
+ * @param depth: the generations calculated between barriers
+ * @param firstTouch: 1 to leave the windows for their threads to clear
+ * @return nothing
+ */
+static void initializeTemporalBlocking(int numThreads,
+	threadArg* threadInput, int partType, int depth, int firstTouch){
+	int i;
+	int winRows;
+	int winCols;
+
+	for(i = 0; i < numThreads; i++){
+		threadInput[i].depth = depth;
+		threadInput[i].localCurrent = NULL;
+		threadInput[i].localNext = NULL;
+		if(depth == 1){
+			continue;
+		}
+		threadInput[i].rowBand = partType == PARTITION_ROW;
+		if(threadInput[i].rowBand){
+			threadInput[i].winRow = threadInput[i].begRow - depth;
+			threadInput[i].winCol = 0;
+			winRows = threadInput[i].endRow - threadInput[i].begRow + 1 +
+				2 * depth;
+			winCols = threadInput[i].maxCol;
+		}
+		else{
+			threadInput[i].winRow = 0;
+			threadInput[i].winCol = threadInput[i].begCol - depth;
+			winRows = threadInput[i].maxRow;
+			winCols = threadInput[i].endCol - threadInput[i].begCol + 1 +
+				2 * depth;
+		}
+		if(firstTouch){
+			threadInput[i].localCurrent = allocateBoard(winRows,winCols);
+			threadInput[i].localNext = allocateBoard(winRows,winCols);
+		}
+		else{
+			threadInput[i].localCurrent = initializeBoard(winRows,winCols);
+			threadInput[i].localNext = initializeBoard(winRows,winCols);
+		}
+	}
+}
+
+/**
+ * Gives every thread the active region and the live counts of the tiles
+ * its slice overlaps, which the tile partition keeps in the active region
+ * instead. Must be called after partition.
+ * @param numThreads: The number of threads created
+ * @param threadInput: The array of thread inputs
+ * @param tiles: the active region, NULL to recalculate every cell
+ * @return nothing
+ * @throws exit(1) if the live counts can not be allocated
+ */
+static void initializeActiveRegion(int numThreads, threadArg* threadInput,
+	tileMap* tiles){
+	int i;
+	int regions;
+
+	for(i = 0; i < numThreads; i++){
+		threadInput[i].generation = 0;
+		threadInput[i].tiles = tiles;
+		threadInput[i].regionLive = NULL;
+		threadInput[i].tilesDone = 0;
+		threadInput[i].steals = 0;
+		if(tiles != NULL && threadInput[i].schedule == NULL){
+			regions = (threadInput[i].endRow / tiles->tileSize -
+				threadInput[i].begRow / tiles->tileSize + 1) *
+				(threadInput[i].endCol / tiles->tileSize -
+				threadInput[i].begCol / tiles->tileSize + 1);
+			threadInput[i].regionLive = (int*) calloc(regions, sizeof(int));
+			if(threadInput[i].regionLive == NULL){
+				printf("%s", "error allocating tile live counts");
+				exit(1);
+			}
+		}
+	}
+}
+
+/**
+ * Allocates the per-thread live count slots, two per thread. Each slot is
+ * on its own cache line so threads storing their counts do not invalidate
+ * each other's.
+ * @param numThreads: The number of threads created
+ * @return: the array of slots
+ * @throws exit(1) if the slots can not be allocated
+ */
+static liveCountSlot* initializeLiveCounts(int numThreads){
+	liveCountSlot* slots;
+
+	slots = (liveCountSlot*) aligned_alloc(CACHE_LINE,
+		2 * numThreads * sizeof(liveCountSlot));
+	if(slots == NULL){
+		printf("%s", "error allocating live counts");
+		exit(1);
+	}
+	memset(slots, 0, 2 * numThreads * sizeof(liveCountSlot));
+	return slots;
+}
+
+/**
+ * Sums the live counts, tiles recalculated and hashes the threads stored for
+ * the generations that were just calculated into the simulator's counts. Must
+ * be called by one thread after the barrier that ends the generations and
+ * before the barrier that ends the step after them.
+ * @param sim: the simulator
+ * @param phase: the step whose slots are summed
+ * @return nothing
+ */
+static void reduceLiveCounts(simulator* sim, int phase){
+	int i;
+	int liveCells = 0;
+	long long tilesProcessed = 0;
+	long long liveTotal = 0;
+	uint64_t hash = 0;
+	liveCountSlot* slot;
+
+	for(i = 0; i < sim->opts.numThreads; i++){
+		slot = &sim->slots[2 * i + (phase & 1)];
+		liveCells += slot->liveCells;
+		liveTotal += slot->liveTotal;
+		tilesProcessed += slot->tilesProcessed;
+		hash += slot->hash;
+	}
+	sim->liveCount = liveCells;
+	sim->hash = hash;
+	sim->totalLiveCount += liveTotal;
+	sim->tilesProcessed = tilesProcessed;
+	sim->totalTilesProcessed += tilesProcessed;
+}
+
+/**
+ * Adds the current board to the history of the last generations, unless it
+ * is already in it. The nearest match is the smallest period. A match is
+ * only a candidate, two boards can share a hash, so confirmCycle compares
+ * the boards a period apart before the period is used. Must be called by
+ * one thread after the hashes of the generation were summed.
+ * @param sim: the simulator
+ * @return: 1 if the board's hash and live count repeat a generation of the
+ *          history, 0 otherwise
+ */
+static int findCycle(simulator* sim){
+	int size = sim->opts.cycleHistory;
+	int back;
+	cycleEntry* entry;
+
+	for(back = 1; back <= sim->historyCount; back++){
+		entry = &sim->history[(sim->historyNext - back + size) % size];
+		if(entry->hash == sim->hash && entry->liveCount == sim->liveCount){
+			sim->candidatePeriod = back;
+			return 1;
+		}
+	}
+	sim->history[sim->historyNext].hash = sim->hash;
+	sim->history[sim->historyNext].liveCount = sim->liveCount;
+	sim->historyNext = (sim->historyNext + 1) % size;
+	if(sim->historyCount < size){
+		sim->historyCount++;
+	}
+	return 0;
+}
+
+/**
+ * Initializes the barrier the threads wait at between generations. The spin
+ * barrier and the pipeline only spin while every thread can have a core,
+ * with more threads the thread waited for may need the core and waiting
+ * threads sleep at once.
+ * @param sim: the simulator, its options give the threads and barrier type
+ * @return nothing
+ */
+static void initializeBarrier(simulator* sim){
+	int numThreads = sim->opts.numThreads;
+
+	sim->spinRounds = numThreads <= sysconf(_SC_NPROCESSORS_ONLN) ?
+		SPIN_LIMIT : 0;
+	if(sim->opts.barrier == BARRIER_SPIN){
+		initializeSpinBarrier(&sim->spinSync,numThreads,sim->spinRounds);
+	}
+	else{
+		pthread_barrier_init(&sim->barrier,NULL,numThreads);
+	}
+}
+
+/**
+ * Waits at the simulator's barrier until every thread of its pool arrived
+ * @param sim: the simulator
+ * @return nothing
+ */
+static void syncThreads(simulator* sim){
+	if(sim->opts.barrier == BARRIER_SPIN){
+		spinBarrierWait(&sim->spinSync);
+	}
+	else{
+		pthread_barrier_wait(&sim->barrier);
+	}
+}
+
+/**
+ * Checks if the cells lo to hi along the band direction, which wrap around
+ * a board of size cells if wrap, overlap the band beg to end
+ * @param lo: the first cell, may be negative
+ * @param hi: the last cell, may be past the board
+ * @param beg: the first cell of the band
+ * @param end: the last cell of the band
+ * @param size: the number of cells along the band direction
+ * @param wrap: 0 for nowrap 1 for wrap
+ * @return: 1 if they overlap, 0 otherwise
+ */
+static int bandsTouch(int lo, int hi, int beg, int end, int size, int wrap){
+	if(!wrap){
+		return lo <= end && beg <= hi;
+	}
+	if(hi - lo + 1 >= size){
+		return 1;
+	}
+	return (lo <= end && beg <= hi) ||
+		(lo <= end - size && beg - size <= hi) ||
+		(lo <= end + size && beg + size <= hi);
+}
+
+/**
+ * Checks if a thread reads cells of another thread's band when it
+ * calculates its own: the depth cells next to its band, or with an active
+ * region the tiles next to its tiles, whose change marks it reads.
+ * @param arg: the thread's arguments
+ * @param other: the other thread's arguments
+ * @param rowBand: 1 for row partition, 0 for col partition
+ * @param tiles: the active region, may be NULL
+ * @return: 1 if it reads the other band, 0 otherwise
+ */
+static int readsBand(threadArg* arg, threadArg* other, int rowBand,
+	tileMap* tiles){
+	int beg = rowBand ? arg->begRow : arg->begCol;
+	int end = rowBand ? arg->endRow : arg->endCol;
+	int otherBeg = rowBand ? other->begRow : other->begCol;
+	int otherEnd = rowBand ? other->endRow : other->endCol;
+	int size = rowBand ? arg->maxRow : arg->maxCol;
+	int numTiles;
+	int tile;
+	int t;
+
+	if(beg > end || otherBeg > otherEnd){
+		return 0;
+	}
+	if(tiles == NULL){
+		return bandsTouch(beg - arg->depth,end + arg->depth,otherBeg,
+			otherEnd,size,arg->wrap);
+	}
+	numTiles = rowBand ? tiles->tileRows : tiles->tileCols;
+	for(t = beg / tiles->tileSize - 1; t <= end / tiles->tileSize + 1; t++){
+		tile = t;
+		if(arg->wrap){
+			tile = (t + numTiles) % numTiles;
+		}
+		else if(t < 0 || t >= numTiles){
+			continue;
+		}
+		if(bandsTouch(tile * tiles->tileSize,
+			(tile + 1) * tiles->tileSize - 1,otherBeg,otherEnd,size,0)){
+			return 1;
+		}
+	}
+	return 0;
+}
+
+/**
+ * Sets up the pipeline used instead of a barrier per generation when the
+ * board is split into row or col bands. A thread then only waits until the
+ * threads whose cells it reads finished the step before, and those can only
+ * be one step ahead of it since they read its cells too. The bitpack
+ * kernel's words do not follow the column bands, so bitpack col partitions
+ * keep the barrier, and so does cycle detection, which sums the hashes of
+ * every generation. Must be called after partition.
+ * @param sim: the simulator
+ * @return nothing
+ * @throws exit(1) if the pipeline can not be allocated
+ */
+static void initializePipeline(simulator* sim){
+	threadArg* threadInput = sim->threadInput;
+	int numThreads = sim->opts.numThreads;
+	int rowBand = sim->opts.partition == PARTITION_ROW;
+	int i;
+	int j;
+
+	memset(sim->progress, 0, numThreads * sizeof(progressFlag));
+	for(i = 0; i < numThreads; i++){
+		threadInput[i].phase = 0;
+		threadInput[i].pipeline = 0;
+		threadInput[i].neighbors = NULL;
+		threadInput[i].numNeighbors = 0;
+	}
+	if(sim->opts.partition == PARTITION_TILE ||
+		(!rowBand && sim->opts.kernel == KERNEL_BITPACK) ||
+		sim->opts.cycleHistory > 0){
+		return;
+	}
+	for(i = 0; i < numThreads; i++){
+		threadInput[i].pipeline = 1;
+		threadInput[i].neighbors = (int*) malloc(numThreads * sizeof(int));
+		if(threadInput[i].neighbors == NULL){
+			printf("%s", "error allocating pipeline");
+			exit(1);
+		}
+		for(j = 0; j < numThreads; j++){
+			if(j != i && readsBand(&threadInput[i],&threadInput[j],rowBand,
+				sim->tiles)){
+				threadInput[i].neighbors[threadInput[i].numNeighbors++] = j;
+			}
+		}
+	}
+}
+
+/**
+ * Waits until every thread whose cells a thread reads completed the steps
+ * before the one it is about to calculate
+ * @param arg: the thread's arguments
+ * @return nothing
+ */
+static void waitForNeighbors(threadArg* arg){
+	int i;
+
+	for(i = 0; i < arg->numNeighbors; i++){
+		waitProgress(&arg->sim->progress[arg->neighbors[i]],arg->phase,
+			arg->sim->spinRounds);
+	}
+}
+
+/**
+ * Returns the time of a monotonic clock, which NTP adjustments do not move
+ * @return: the time in nanoseconds
+ */
+static long long monotonicTime(void){
+	struct timespec time;
+
+	clock_gettime(CLOCK_MONOTONIC, &time);
+	return time.tv_sec * 1000000000LL + time.tv_nsec;
+}
+
+/**
+ * Adds a phase of a thread to its profile, and to its trace if the
+ * simulator keeps one
+ * @param sim: the simulator
+ * @param profile: the thread's profile
+ * @param type: one of the TRACE_ values
+ * @param begin: the time the phase began
+ * @param end: the time the phase ended
+ * @param generation: the generation the thread calculated from
+ * @return nothing
+ * @throws exit(1) if the trace can not be allocated
+ */
+static void recordPhase(simulator* sim, threadProfile* profile, int type,
+	long long begin, long long end, int generation){
+	traceEvent* event;
+
+	if(type == TRACE_COMPUTE){
+		profile->computeTime += end - begin;
+		if(end - begin > profile->slowestStep){
+			profile->slowestStep = end - begin;
+		}
+	}
+	else if(type == TRACE_BARRIER){
+		profile->barrierTime += end - begin;
+	}
+	else{
+		profile->neighborTime += end - begin;
+	}
+	if(sim->opts.profile != PROFILE_TRACE){
+		return;
+	}
+	if(profile->numEvents == profile->eventCapacity){
+		profile->eventCapacity = profile->eventCapacity > 0 ?
+			2 * profile->eventCapacity : 1024;
+		profile->events = (traceEvent*) realloc(profile->events,
+			profile->eventCapacity * sizeof(traceEvent));
+		if(profile->events == NULL){
+			printf("%s", "error allocating trace");
+			exit(1);
+		}
+	}
+	event = &profile->events[profile->numEvents++];
+	event->begin = begin;
+	event->end = end;
+	event->type = type;
+	event->generation = generation;
+}
+
+/**
+ * Calculates a thread's slice the number of generations of the simulator's
+ * current job, then stores the thread's state back for the next job. Ends
+ * at a barrier, after which the thread no longer touches the boards. Once
+ * thread 0 finds a cycle every thread stops after the step that follows.
+ * Inlined twice, once with the profile NULL, so an unprofiled run has no
+ * clock reads or branches on the profile in its loop.
+ * @param arguments: pointer to the thread's arguments
+ * @param profile: the thread's profile, NULL if not profiled
+ * @return nothing
+ */
+static inline __attribute__((always_inline)) void runSteps(
+	threadArg* arguments, threadProfile* profile){
+	threadArg localArg = arguments[0];
+	simulator* sim = localArg.sim;
+	int iterations = sim->jobSteps;
+	int i;
+	int steps = 1;
+	int liveCells = 0;
+	long long liveTotal = 0;
+	long long tilesProcessed = 0;
+	long long begin = 0;
+	long long waited = 0;
+	long long computed = 0;
+	long long synced = 0;
+	liveCountSlot* slot;
+	cellBoard* swapTemp;
+	bitBoard* swapBits;
+
+	for(i = 0; i < iterations;i += steps){
+		if(localArg.pipeline){
+			if(profile != NULL){
+				begin = monotonicTime();
+			}
+			waitForNeighbors(&localArg);
+		}
+		if(profile != NULL){
+			waited = monotonicTime();
+		}
+		if(localArg.depth > 1){
+			steps = iterations - i < localArg.depth ?
+				iterations - i : localArg.depth;
+			calcTemporalBlock(&localArg,steps);
+		}
+		else{
+			calcSlice(&localArg);
+		}
+		if(profile != NULL){
+			computed = monotonicTime();
+		}
+		//swap boards so the previous "next iteration" is the current board
+		swapTemp = localArg.currentBoard;
+		localArg.currentBoard = localArg.nextBoard;
+		localArg.nextBoard = swapTemp;
+		swapBits = localArg.currentBits;
+		localArg.currentBits = localArg.nextBits;
+		localArg.nextBits = swapBits;
+		if(localArg.pipeline){
+			slot = threadSlot(&localArg);
+			liveCells = slot->liveCells;
+			liveTotal += slot->liveTotal;
+			tilesProcessed += slot->tilesProcessed;
+			publishProgress(&sim->progress[localArg.threadNum],
+				localArg.phase + 1);
+		}
+		else{
+			//the next step's deque is filled before anyone can start it
+			if(localArg.schedule != NULL){
+				fillTileDeque(localArg.schedule,localArg.threadNum,
+					localArg.phase + 1);
+			}
+			syncThreads(sim);
+			if(profile != NULL){
+				synced = monotonicTime();
+			}
+			//this step's slots are not written again before the next
+			//step's barrier
+			if(localArg.threadNum == 0){
+				reduceLiveCounts(sim,localArg.phase);
+				//the others see the stop after the next step's barrier
+				if(sim->detecting && sim->candidatePeriod == 0 &&
+					findCycle(sim)){
+					__atomic_store_n(&sim->stopGeneration,
+						localArg.generation + steps + 1,__ATOMIC_RELAXED);
+				}
+			}
+		}
+		if(profile != NULL){
+			if(localArg.pipeline){
+				recordPhase(sim,profile,TRACE_NEIGHBORS,begin,waited,
+					localArg.generation);
+			}
+			recordPhase(sim,profile,TRACE_COMPUTE,waited,computed,
+				localArg.generation);
+			if(!localArg.pipeline){
+				recordPhase(sim,profile,TRACE_BARRIER,computed,synced,
+					localArg.generation);
+			}
+			profile->generations += steps;
+		}
+		localArg.phase++;
+		localArg.generation += steps;
+		if(localArg.generation >= __atomic_load_n(&sim->stopGeneration,
+			__ATOMIC_RELAXED)){
+			break;
+		}
+	}
+	if(localArg.pipeline){
+		//sum the counts of the whole job once everyone is done
+		slot = &sim->slots[2 * localArg.threadNum];
+		slot->liveCells = liveCells;
+		slot->liveTotal = liveTotal;
+		slot->tilesProcessed = tilesProcessed;
+	}
+	arguments[0] = localArg;
+	if(profile != NULL){
+		begin = monotonicTime();
+	}
+	syncThreads(sim);
+	if(profile != NULL){
+		recordPhase(sim,profile,TRACE_BARRIER,begin,monotonicTime(),
+			localArg.generation);
+	}
+	if(localArg.pipeline && localArg.threadNum == 0 && iterations > 0){
+		reduceLiveCounts(sim,0);
+	}
+}
+
+/**
+ * Driver function of a thread of the pool. Runs the thread's slice of the
+ * simulator's current job, timing its phases if the simulator is profiled.
+ * @param arguments: pointer to the thread's arguments
+ * @return nothing
+ */
+static void runSlice(threadArg* arguments){
+	threadProfile* profiles = arguments->sim->profiles;
+
+	if(profiles != NULL){
+		runSteps(arguments,&profiles[arguments->threadNum]);
+	}
+	else{
+		runSteps(arguments,NULL);
+	}
+}
+
+/**
+ * Sets every cell of the rows of new boards a thread calculates to 0, the
+ * first write to them, so with NUMA first-touch placement the pages of the
+ * rows land on the node of the thread that reads and writes them every
+ * generation. The rows are the thread's band with row partitions and an
+ * even share of the rows otherwise, thread 0 and the last thread also
+ * clear the rows past the edges. Ends at a barrier.
+ * @param arg: the thread's arguments
+ * @return nothing
+ */
+static void touchSlice(threadArg* arg){
+	int begRow;
+	int endRow;
+
+	if(arg->sim->opts.partition == PARTITION_ROW){
+		begRow = arg->begRow;
+		endRow = arg->endRow + 1;
+	}
+	else{
+		begRow = (int) ((long long) arg->maxRow * arg->threadNum /
+			arg->numThreads);
+		endRow = (int) ((long long) arg->maxRow * (arg->threadNum + 1) /
+			arg->numThreads);
+	}
+	if(arg->threadNum == 0){
+		begRow = -1;
+	}
+	if(arg->threadNum == arg->numThreads - 1){
+		endRow = arg->maxRow + 1;
+	}
+	if(arg->currentBits != NULL){
+		clearBitRows(arg->currentBits,begRow > 0 ? begRow : 0,endRow);
+		clearBitRows(arg->nextBits,begRow > 0 ? begRow : 0,endRow);
+	}
+	else{
+		clearBoardRows(arg->currentBoard,begRow,endRow);
+		clearBoardRows(arg->nextBoard,begRow,endRow);
+	}
+	if(arg->localCurrent != NULL){
+		clearBoardRows(arg->localCurrent,-1,arg->localCurrent->rows + 1);
+		clearBoardRows(arg->localNext,-1,arg->localNext->rows + 1);
+	}
+	syncThreads(arg->sim);
+}
+
+/**
+ * Driver function of a thread created for the pool. Sleeps until the next
+ * job is published and runs its slice of it, until the simulator quits.
+ * @param arguments: pointer to the worker's poolWorker
+ * @return NULL
+ */
+static void* runWorker(void* arguments){
+	poolWorker* worker = (poolWorker*) arguments;
+	simulator* sim = worker->sim;
+	unsigned int job = 0;
+
+	while(1){
+		job++;
+		waitProgress(&sim->start,job,sim->spinRounds);
+		if(sim->quit){
+			return NULL;
+		}
+		if(sim->jobKind == JOB_TOUCH){
+			touchSlice(&sim->threadInput[worker->threadNum]);
+		}
+		else{
+			runSlice(&sim->threadInput[worker->threadNum]);
+		}
+	}
+}
+
+/**
+ * Passes values into the threadArg array so each thread gets the info it
+ * needs to run the specific slice of the game given to them. Must be called
+ * after the boards, the active region and the scheduler were created.
+ * @param sim: the simulator
+ * @return an array of threadArg inputs
+ * @throws exit(1) if the array can not be allocated
+ */
+static threadArg* initializeThreadInput(simulator* sim){
+	int numThreads = sim->opts.numThreads;
+	int i;
+	threadArg* threadInput;
+
+	threadInput = (threadArg*) malloc(numThreads*sizeof(threadArg));
+	if(threadInput == NULL){
+		printf("%s", "error allocating thread input");
+		exit(1);
+	}
+	memset(threadInput, 0, numThreads * sizeof(threadArg));
+	for(i = 0; i < numThreads; i++){
+		threadInput[i].sim = sim;
+		threadInput[i].maxRow = sim->rows;
+		threadInput[i].maxCol = sim->cols;
+		threadInput[i].wrap = sim->opts.wrap;
+		threadInput[i].kernel = sim->opts.kernel;
+		threadInput[i].simdRow = sim->simdRow;
+		threadInput[i].currentBoard = sim->currentBoard;
+		threadInput[i].nextBoard = sim->nextBoard;
+		threadInput[i].currentBits = sim->currentBits;
+		threadInput[i].nextBits = sim->nextBits;
+		threadInput[i].schedule = sim->schedule;
+		threadInput[i].tileSize = sim->opts.tileSize;
+		threadInput[i].threadNum = i;
+		threadInput[i].numThreads = numThreads;
+	}
+
+	return threadInput;
+}
+
+/**
+ * Creates the hash keys of the rows and of the columns, or words for
+ * bitpack, and the history of cycle detection, if it is on
+ * @param sim: the simulator, with its size set
+ * @return nothing
+ * @throws exit(1) if the keys can not be allocated
+ */
+static void initializeCycleKeys(simulator* sim){
+	int numCols = sim->opts.kernel == KERNEL_BITPACK ?
+		(sim->cols + BITS_PER_WORD - 1) / BITS_PER_WORD : sim->cols;
+	int i;
+
+	if(sim->opts.cycleHistory == 0){
+		return;
+	}
+	sim->rowKeys = (uint64_t*) malloc(sim->rows * sizeof(uint64_t));
+	sim->colKeys = (uint64_t*) malloc(numCols * sizeof(uint64_t));
+	sim->history = (cycleEntry*) malloc(sim->opts.cycleHistory *
+		sizeof(cycleEntry));
+	if(sim->rowKeys == NULL || sim->colKeys == NULL || sim->history == NULL){
+		printf("%s", "error allocating cycle detection");
+		exit(1);
+	}
+	//odd row keys keep every bit of the row sums
+	for(i = 0; i < sim->rows; i++){
+		sim->rowKeys[i] = mixKey(2 * (uint64_t) i + 1) | 1;
+	}
+	for(i = 0; i < numCols; i++){
+		sim->colKeys[i] = mixKey(2 * (uint64_t) i + 2);
+	}
+}
+
+/**
+ * Sets up the boards and the threads' slices of the threaded sweep and
+ * sets the live cells on the current board
+ * @param sim: the simulator, with its size set
+ * @param cells: row, column pairs of the live cells
+ * @param numCells: the number of pairs
+ * @return nothing
+ */
+static void loadSweep(simulator* sim, const int* cells, int numCells){
+	simOptions* opts = &sim->opts;
+	int i;
+
+	//with numa the boards are cleared by the threads, before the cells are set
+	if(opts->kernel == KERNEL_BITPACK){
+		sim->currentBits = opts->numa ? allocateBitBoard(sim->rows,sim->cols) :
+			initializeBitBoard(sim->rows,sim->cols);
+		sim->nextBits = opts->numa ? allocateBitBoard(sim->rows,sim->cols) :
+			initializeBitBoard(sim->rows,sim->cols);
+	}
+	else{
+		sim->currentBoard = opts->numa ? allocateBoard(sim->rows,sim->cols) :
+			initializeBoard(sim->rows,sim->cols);
+		sim->nextBoard = opts->numa ? allocateBoard(sim->rows,sim->cols) :
+			initializeBoard(sim->rows,sim->cols);
+	}
+	if(opts->tileSize > 0 && opts->kernel != KERNEL_BITPACK &&
+		opts->depth == 1){
+		sim->tiles = initializeTileMap(sim->rows,sim->cols,opts->tileSize,
+			opts->wrap);
+	}
+	if(opts->partition == PARTITION_TILE){
+		//bitpack tiles are bands of whole rows
+		if(sim->tiles == NULL){
+			sim->schedule = initializeTileSchedule(
+				(sim->rows + opts->tileSize - 1) / opts->tileSize,
+				opts->numThreads);
+		}
+		else{
+			sim->schedule = initializeTileSchedule(
+				sim->tiles->tileRows * sim->tiles->tileCols,
+				opts->numThreads);
+		}
+		for(i = 0; i < opts->numThreads; i++){
+			fillTileDeque(sim->schedule,i,0);
+		}
+	}
+	sim->threadInput = initializeThreadInput(sim);
+	partition(opts->numThreads,sim->rows,sim->cols,opts->partition,
+		sim->threadInput);
+	initializeActiveRegion(opts->numThreads,sim->threadInput,sim->tiles);
+	initializeTemporalBlocking(opts->numThreads,sim->threadInput,
+		opts->partition,opts->depth,opts->numa);
+	initializePipeline(sim);
+	initializeCycleKeys(sim);
+	memset(sim->slots, 0, 2 * opts->numThreads * sizeof(liveCountSlot));
+	if(opts->numa){
+		sim->jobKind = JOB_TOUCH;
+		publishProgress(&sim->start,++sim->jobs);
+		touchSlice(&sim->threadInput[0]);
+	}
+	if(opts->kernel == KERNEL_BITPACK){
+		for(i = 0; i < numCells; i++){
+			setBitCell(sim->currentBits,cells[2*i],cells[2*i+1]);
+		}
+	}
+	else{
+		for(i = 0; i < numCells; i++){
+			CELL(sim->currentBoard,cells[2*i],cells[2*i+1]) = 1;
+		}
+		if(opts->wrap){
+			refreshHalo(sim->currentBoard);
+		}
+	}
+}
+
+/**
+ * Frees the boards and everything else that belongs to the loaded board
+ * @param sim: the simulator
+ * @return nothing
+ */
+static void freeBoardState(simulator* sim){
+	int i;
+
+	freeBoard(sim->currentBoard);
+	freeBoard(sim->nextBoard);
+	freeBitBoard(sim->currentBits);
+	freeBitBoard(sim->nextBits);
+	freeHashlife(sim->hl);
+	freeTileMap(sim->tiles);
+	freeTileSchedule(sim->schedule);
+	if(sim->threadInput != NULL){
+		for(i = 0; i < sim->opts.numThreads; i++){
+			free(sim->threadInput[i].regionLive);
+			freeBoard(sim->threadInput[i].localCurrent);
+			freeBoard(sim->threadInput[i].localNext);
+			free(sim->threadInput[i].neighbors);
+		}
+	}
+	free(sim->threadInput);
+	free(sim->rowKeys);
+	free(sim->colKeys);
+	free(sim->history);
+	sim->currentBoard = NULL;
+	sim->nextBoard = NULL;
+	sim->currentBits = NULL;
+	sim->nextBits = NULL;
+	sim->hl = NULL;
+	sim->tiles = NULL;
+	sim->schedule = NULL;
+	sim->threadInput = NULL;
+	sim->rowKeys = NULL;
+	sim->colKeys = NULL;
+	sim->history = NULL;
+	sim->historyCount = 0;
+	sim->historyNext = 0;
+	sim->candidatePeriod = 0;
+	if(sim->cycleStart != NULL){
+		freeCheckpoint(sim->cycleStart);
+		sim->cycleStart = NULL;
+	}
+	sim->period = 0;
+	sim->loaded = 0;
+}
+
+/**
+ * Clears the profile of every thread for a new board, keeping the memory of
+ * the traces
+ * @param sim: the simulator
+ * @return nothing
+ */
+static void clearProfiles(simulator* sim){
+	threadProfile* profile;
+	int i;
+
+	if(sim->profiles == NULL){
+		return;
+	}
+	for(i = 0; i < sim->opts.numThreads; i++){
+		profile = &sim->profiles[i];
+		profile->computeTime = 0;
+		profile->barrierTime = 0;
+		profile->neighborTime = 0;
+		profile->slowestStep = 0;
+		profile->generations = 0;
+		profile->numEvents = 0;
+	}
+	sim->profileStart = monotonicTime();
+}
+
+/**
+ * Fills in the default options: one thread, row partition, nowrap, the
+ * scalar kernel of the threaded sweep, tiles of TILE_SIZE, depth 1, the
+ * spin barrier, no profiling, no pinning and no cycle detection
+ * @param opts: the options to fill in
+ * @return nothing
+ */
+void defaultSimOptions(simOptions* opts){
+	opts->numThreads = 1;
+	opts->partition = PARTITION_ROW;
+	opts->wrap = 0;
+	opts->kernel = KERNEL_SCALAR;
+	opts->simdIsa = SIMD_AUTO;
+	opts->engine = ENGINE_SWEEP;
+	opts->tileSize = TILE_SIZE;
+	opts->depth = 1;
+	opts->barrier = BARRIER_SPIN;
+	opts->profile = PROFILE_OFF;
+	opts->numa = 0;
+	opts->cycleHistory = 0;
+}
+
+/**
+ * Reads one optional argument, --kernel, --simd, --engine, --tile, --depth
+ * or --barrier with its value, or --profile, --numa or --cycles, with the
+ * generations searched for a repeat or CYCLE_HISTORY, into opts
+ * @param opts: the options to change
+ * @param arg: the argument, for example "--kernel=simd"
+ * @return: NULL if it was read, why it is invalid otherwise
+ */
+const char* parseSimOption(simOptions* opts, const char* arg){
+	if(strncmp(arg,"--kernel=",9) == 0){
+		if(strcmp(arg+9,"scalar") == 0){
+			opts->kernel = KERNEL_SCALAR;
+		}
+		else if(strcmp(arg+9,"bitpack") == 0){
+			opts->kernel = KERNEL_BITPACK;
+		}
+		else if(strcmp(arg+9,"simd") == 0){
+			opts->kernel = KERNEL_SIMD;
+		}
+		else if(strcmp(arg+9,"lut") == 0){
+			opts->kernel = KERNEL_LUT;
+		}
+		else if(strcmp(arg+9,"rolling") == 0){
+			opts->kernel = KERNEL_ROLLING;
+		}
+		else{
+			return "invalid kernel argument";
+		}
+	}
+	else if(strncmp(arg,"--simd=",7) == 0){
+		if(strcmp(arg+7,"auto") == 0){
+			opts->simdIsa = SIMD_AUTO;
+		}
+		else if(strcmp(arg+7,"avx512") == 0){
+			opts->simdIsa = SIMD_AVX512;
+		}
+		else if(strcmp(arg+7,"avx2") == 0){
+			opts->simdIsa = SIMD_AVX2;
+		}
+		else if(strcmp(arg+7,"sse2") == 0){
+			opts->simdIsa = SIMD_SSE2;
+		}
+		else if(strcmp(arg+7,"scalar") == 0){
+			opts->simdIsa = SIMD_SCALAR;
+		}
+		else{
+			return "invalid simd argument";
+		}
+	}
+	else if(strncmp(arg,"--engine=",9) == 0){
+		if(strcmp(arg+9,"sweep") == 0){
+			opts->engine = ENGINE_SWEEP;
+		}
+		else if(strcmp(arg+9,"hashlife") == 0){
+			opts->engine = ENGINE_HASHLIFE;
+		}
+		else{
+			return "invalid engine argument";
+		}
+	}
+	else if(strncmp(arg,"--tile=",7) == 0){
+		if(arg[7] == '\0' ||
+			strspn(arg+7,"0123456789") != strlen(arg+7)){
+			return "invalid tile argument";
+		}
+		opts->tileSize = atoi(arg+7);
+	}
+	else if(strncmp(arg,"--depth=",8) == 0){
+		if(arg[8] == '\0' || atoi(arg+8) < 1 ||
+			strspn(arg+8,"0123456789") != strlen(arg+8)){
+			return "invalid depth argument";
+		}
+		opts->depth = atoi(arg+8);
+	}
+	else if(strncmp(arg,"--barrier=",10) == 0){
+		if(strcmp(arg+10,"spin") == 0){
+			opts->barrier = BARRIER_SPIN;
+		}
+		else if(strcmp(arg+10,"pthread") == 0){
+			opts->barrier = BARRIER_PTHREAD;
+		}
+		else{
+			return "invalid barrier argument";
+		}
+	}
+	else if(strcmp(arg,"--profile") == 0){
+		opts->profile = PROFILE_SUMMARY;
+	}
+	else if(strcmp(arg,"--numa") == 0){
+		opts->numa = 1;
+	}
+	else if(strcmp(arg,"--cycles") == 0){
+		opts->cycleHistory = CYCLE_HISTORY;
+	}
+	else if(strncmp(arg,"--cycles=",9) == 0){
+		if(arg[9] == '\0' || atoi(arg+9) < 1 ||
+			strspn(arg+9,"0123456789") != strlen(arg+9)){
+			return "invalid cycles argument";
+		}
+		opts->cycleHistory = atoi(arg+9);
+	}
+	else{
+		return "invalid option argument";
+	}
+	return NULL;
+}
+
+/**
+ * Checks that options can be used together. Picks the simd row function
+ * when the kernel is simd and builds the table of the lut kernel.
+ * @param opts: the options
+ * @return: NULL if they are valid, why they are not otherwise
+ */
+const char* checkSimOptions(const simOptions* opts){
+	if(opts->numThreads <= 0){
+		return "number of threads must be greater than 0";
+	}
+	if(opts->partition != PARTITION_ROW && opts->partition != PARTITION_COL &&
+		opts->partition != PARTITION_TILE){
+		return "invalid partition argument";
+	}
+	if(opts->depth < 1){
+		return "invalid depth argument";
+	}
+	if(opts->tileSize < 0){
+		return "invalid tile argument";
+	}
+	if(opts->profile < PROFILE_OFF || opts->profile > PROFILE_TRACE){
+		return "invalid profile argument";
+	}
+	if(opts->cycleHistory < 0){
+		return "invalid cycles argument";
+	}
+	if(opts->cycleHistory > 0 && (opts->engine == ENGINE_HASHLIFE ||
+		opts->depth > 1)){
+		return "cycle detection needs the sweep engine and depth 1";
+	}
+	if(opts->engine == ENGINE_HASHLIFE){
+		return NULL;
+	}
+	if(opts->depth > 1 && (opts->kernel == KERNEL_BITPACK ||
+		opts->partition == PARTITION_TILE)){
+		return "depth above 1 needs row or col partition and a byte grid";
+	}
+	if(opts->partition == PARTITION_TILE && opts->tileSize == 0){
+		return "tile partition needs a tile size above 0";
+	}
+	if(opts->kernel == KERNEL_SIMD && pickSimdKernel(opts->simdIsa) == NULL){
+		return "simd instruction set not supported by this cpu";
+	}
+	if(opts->kernel == KERNEL_LUT){
+		initializeLutKernel();
+	}
+	return NULL;
+}
+
+/**
+ * Picks a CPU for each thread of the pool from the machine's topology, and
+ * pins the calling thread, thread 0, to its CPU. The workers are pinned as
+ * they are created.
+ * @param sim: the simulator
+ * @return nothing
+ * @throws exit(1) if the CPUs can not be allocated
+ */
+static void pinThreads(simulator* sim){
+	cpuTopology* topo;
+	int numThreads = sim->opts.numThreads;
+	int i;
+	int cpu;
+
+	sim->cpus = (int*) malloc(numThreads * sizeof(int));
+	sim->nodes = (int*) malloc(numThreads * sizeof(int));
+	if(sim->cpus == NULL || sim->nodes == NULL){
+		printf("%s", "error allocating simulator");
+		exit(1);
+	}
+	topo = readCpuTopology();
+	for(i = 0; i < numThreads; i++){
+		cpu = threadCpu(topo,i,numThreads);
+		sim->cpus[i] = topo->cpus[cpu];
+		sim->nodes[i] = topo->nodes[cpu];
+	}
+	freeCpuTopology(topo);
+	pinCallingThread(sim->cpus[0]);
+}
+
+/**
+ * Dynamically allocates a simulator with no board and starts its pool,
+ * numThreads-1 threads that wait for jobs (none for Hashlife, which runs
+ * on the calling thread)
+ * @param opts: the options of the simulator
+ * @return: returns a pointer to the newly initialized simulator, NULL if the
+ *          options are invalid (see checkSimOptions)
+ * @throws exit(1) if the simulator or its threads can not be created
+ */
+simulator* createSimulator(const simOptions* opts){
+	simulator* sim;
+	pthread_attr_t attr;
+	int i;
+
+	if(checkSimOptions(opts) != NULL){
+		return NULL;
+	}
+	sim = (simulator*) aligned_alloc(CACHE_LINE, sizeof(simulator));
+	if(sim == NULL){
+		printf("%s", "error allocating simulator");
+		exit(1);
+	}
+	memset(sim, 0, sizeof(simulator));
+	sim->opts = *opts;
+	sim->error = "";
+	if(opts->kernel == KERNEL_SIMD){
+		sim->simdRow = pickSimdKernel(opts->simdIsa);
+	}
+	initializeBarrier(sim);
+	sim->slots = initializeLiveCounts(opts->numThreads);
+	sim->progress = (progressFlag*) aligned_alloc(CACHE_LINE,
+		opts->numThreads * sizeof(progressFlag));
+	sim->workers = (poolWorker*) malloc(opts->numThreads *
+		sizeof(poolWorker));
+	sim->workerID = (pthread_t*) malloc(opts->numThreads *
+		sizeof(pthread_t));
+	if(sim->progress == NULL || sim->workers == NULL ||
+		sim->workerID == NULL){
+		printf("%s", "error allocating simulator");
+		exit(1);
+	}
+	memset(sim->progress, 0, opts->numThreads * sizeof(progressFlag));
+	if(opts->profile != PROFILE_OFF){
+		sim->profiles = (threadProfile*) aligned_alloc(CACHE_LINE,
+			opts->numThreads * sizeof(threadProfile));
+		if(sim->profiles == NULL){
+			printf("%s", "error allocating simulator");
+			exit(1);
+		}
+		memset(sim->profiles, 0, opts->numThreads * sizeof(threadProfile));
+	}
+	if(opts->engine == ENGINE_HASHLIFE){
+		return sim;
+	}
+	if(opts->numa){
+		pinThreads(sim);
+	}
+	for(i = 1; i < opts->numThreads; i++){
+		sim->workers[i].sim = sim;
+		sim->workers[i].threadNum = i;
+		pthread_attr_init(&attr);
+		if(sim->cpus != NULL){
+			setAttrCpu(&attr,sim->cpus[i]);
+		}
+		if(pthread_create(&sim->workerID[i],&attr,runWorker,
+			&sim->workers[i]) != 0){
+			printf("%s", "error creating threads");
+			exit(1);
+		}
+		pthread_attr_destroy(&attr);
+		sim->numWorkers++;
+	}
+	return sim;
+}
+
+/**
+ * Ends the pool's threads and frees the memory allocated for a simulator
+ * @param sim: the simulator to free, may be NULL
+ * @return nothing
+ */
+void destroySimulator(simulator* sim){
+	int i;
+
+	if(sim == NULL){
+		return;
+	}
+	sim->quit = 1;
+	publishProgress(&sim->start,++sim->jobs);
+	for(i = 1; i <= sim->numWorkers; i++){
+		pthread_join(sim->workerID[i],NULL);
+	}
+	freeBoardState(sim);
+	if(sim->opts.barrier == BARRIER_PTHREAD){
+		pthread_barrier_destroy(&sim->barrier);
+	}
+	if(sim->profiles != NULL){
+		for(i = 0; i < sim->opts.numThreads; i++){
+			free(sim->profiles[i].events);
+		}
+	}
+	free(sim->profiles);
+	free(sim->cpus);
+	free(sim->nodes);
+	free(sim->slots);
+	free(sim->progress);
+	free(sim->workers);
+	free(sim->workerID);
+	free(sim);
+}
+
+/**
+ * Replaces the simulator's board with a new one of row x col cells whose
+ * live cells are given, at generation 0. Each pair counts as one live cell
+ * of the initial board.
+ * @param sim: the simulator
+ * @param row: The number of rows in the grid
+ * @param col: The number of columns in the grid
+ * @param cells: row, column pairs of the live cells
+ * @param numCells: the number of pairs
+ * @return: 0 on success, -1 if the board can not be used (see
+ *          simulatorError), the simulator then has no board
+ */
+int loadSimulator(simulator* sim, int row, int col, const int* cells,
+	int numCells){
+	int i;
+
+	freeBoardState(sim);
+	if(row <= 0 || col <= 0){
+		sim->error = "board must have at least one row and column";
+		return -1;
+	}
+	sim->rows = row;
+	sim->cols = col;
+	sim->generation = 0;
+	sim->liveCount = numCells;
+	sim->totalLiveCount = 0;
+	sim->tilesProcessed = 0;
+	sim->totalTilesProcessed = 0;
+	clearProfiles(sim);
+	if(sim->opts.engine == ENGINE_HASHLIFE){
+		sim->hl = initializeHashlife(row,col,sim->opts.wrap);
+		if(sim->hl == NULL){
+			sim->error = "hashlife wrap needs power of two rows and columns";
+			return -1;
+		}
+		for(i = 0; i < numCells; i++){
+			addHashlifeCell(sim->hl,cells[2*i],cells[2*i+1]);
+		}
+		buildHashlife(sim->hl);
+	}
+	else{
+		loadSweep(sim,cells,numCells);
+	}
+	sim->loaded = 1;
+	return 0;
+}
+
+/**
+ * Runs generations of the sweep as one job of the pool
+ * @param sim: the simulator
+ * @param generations: the number of generations
+ * @param detecting: 1 to hash every generation and stop at a cycle
+ * @return: the number of generations calculated, fewer than asked for if a
+ *          cycle was found
+ */
+static int runJob(simulator* sim, int generations, int detecting){
+	int start = sim->threadInput[0].generation;
+	int done;
+
+	sim->detecting = detecting;
+	sim->stopGeneration = INT_MAX;
+	sim->jobKind = JOB_STEP;
+	sim->jobSteps = generations;
+	publishProgress(&sim->start,++sim->jobs);
+	runSlice(&sim->threadInput[0]);
+	sim->currentBoard = sim->threadInput[0].currentBoard;
+	sim->nextBoard = sim->threadInput[0].nextBoard;
+	sim->currentBits = sim->threadInput[0].currentBits;
+	sim->nextBits = sim->threadInput[0].nextBits;
+	done = sim->threadInput[0].generation - start;
+	sim->generation += done;
+	return done;
+}
+
+/**
+ * Empties the history of the last generations and starts it again with the
+ * current board, after generations were calculated without hashing them
+ * @param sim: the simulator
+ * @return nothing
+ */
+static void startCycleHistory(simulator* sim){
+	sim->historyCount = 0;
+	sim->historyNext = 0;
+	sim->hash = sim->currentBits != NULL ?
+		hashWords(sim,sim->currentBits,0,sim->rows,0,
+		sim->currentBits->words) :
+		hashCells(sim,sim->currentBoard,0,0,sim->cols,sim->rows);
+	findCycle(sim);
+}
+
+/**
+ * Checks a candidate period by copying the board, calculating one period
+ * and comparing the two boards. When they are the same the board is known
+ * to repeat from the copied generation, and the live cells of the period
+ * calculated are those of every later period. Otherwise two boards only
+ * shared a hash and the history starts again. The period may be calculated
+ * over several calls, the copy is kept until it is reached.
+ * @param sim: the simulator, with candidatePeriod set
+ * @param generations: the most generations that may be calculated
+ * @return: the number of generations calculated
+ */
+static int confirmCycle(simulator* sim, int generations){
+	int period = sim->candidatePeriod;
+	checkpoint* after;
+	int left;
+	int done;
+
+	if(sim->cycleStart == NULL){
+		sim->cycleStart = snapshotSimulator(sim);
+	}
+	left = sim->cycleStart->generation + period - sim->generation;
+	done = runJob(sim,generations < left ? generations : left,0);
+	if(done < left){
+		return done;
+	}
+	after = snapshotSimulator(sim);
+	if(memcmp(sim->cycleStart->bits,after->bits,(size_t) after->rows *
+		after->words * sizeof(uint64_t)) == 0){
+		sim->period = period;
+		sim->stableGeneration = sim->cycleStart->generation;
+		sim->cycleLiveSum = sim->totalLiveCount -
+			sim->cycleStart->totalLiveCount;
+	}
+	sim->candidatePeriod = 0;
+	freeCheckpoint(sim->cycleStart);
+	sim->cycleStart = NULL;
+	freeCheckpoint(after);
+	if(sim->period == 0){
+		startCycleHistory(sim);
+	}
+	return done;
+}
+
+/**
+ * Advances the loaded board a number of generations. The sweep runs them as
+ * one job of the pool, Hashlife by the largest power of two generations left
+ * at each step. With cycle detection the sweep stops once the board's hash
+ * repeats one of the last generations, and the repeat is confirmed by
+ * comparing the boards a period apart. Then only the live cells of the whole
+ * periods left are added to the counts and the generations past them are
+ * calculated.
+ * @param sim: the simulator
+ * @param generations: the number of generations to advance
+ * @return: 0 on success, -1 if there is no board or generations is negative
+ */
+int stepSimulator(simulator* sim, int generations){
+	int stepLog;
+	int remaining = generations;
+	int periods;
+
+	if(!sim->loaded){
+		sim->error = "no board loaded";
+		return -1;
+	}
+	if(generations < 0){
+		sim->error = "generations must not be negative";
+		return -1;
+	}
+	if(sim->hl != NULL){
+		while(remaining > 0){
+			stepLog = maxHashlifeStep(remaining);
+			sim->totalLiveCount += stepHashlife(sim->hl,stepLog);
+			remaining -= 1 << stepLog;
+		}
+		sim->liveCount = hashlifePopulation(sim->hl);
+		sim->generation += generations;
+		return 0;
+	}
+	if(sim->opts.cycleHistory > 0 && sim->period == 0 &&
+		sim->historyCount == 0){
+		//the loaded board starts the history
+		startCycleHistory(sim);
+	}
+	while(remaining > 0 && sim->period == 0){
+		if(sim->candidatePeriod > 0){
+			remaining -= confirmCycle(sim,remaining);
+		}
+		else{
+			remaining -= runJob(sim,remaining,sim->opts.cycleHistory > 0);
+		}
+	}
+	if(sim->period > 0 && remaining > 0){
+		periods = remaining / sim->period;
+		sim->totalLiveCount += (long long) periods * sim->cycleLiveSum;
+		sim->generation += periods * sim->period;
+		if(remaining % sim->period > 0){
+			runJob(sim,remaining % sim->period,0);
+		}
+	}
+	return 0;
+}
+
+/**
+ * Copies the current board and counts into a checkpoint. Only the calling
+ * thread runs between jobs, so the copy is taken without stopping the
+ * workers any longer than the step already did and can be written out by
+ * another thread while the simulation goes on.
+ * @param sim: the simulator
+ * @return: the checkpoint, NULL if there is no board (see simulatorError)
+ * @throws exit(1) if the checkpoint can not be allocated
+ */
+checkpoint* snapshotSimulator(simulator* sim){
+	checkpoint* cp;
+	uint64_t* words;
+	uint64_t word;
+	const cell* cells;
+	int row, col, bit;
+
+	if(!sim->loaded){
+		sim->error = "no board loaded";
+		return NULL;
+	}
+	cp = initializeCheckpoint(sim->rows,sim->cols,sim->opts.wrap);
+	cp->generation = sim->generation;
+	cp->liveCount = sim->liveCount;
+	cp->totalLiveCount = sim->totalLiveCount;
+	cp->tilesProcessed = simulatorTilesProcessed(sim);
+	cp->tileCount = simulatorTileCount(sim);
+	if(sim->currentBits != NULL){
+		//a bit board's rows are laid out like a checkpoint's
+		memcpy(cp->bits, sim->currentBits->bits,
+			(size_t) cp->rows * cp->words * sizeof(uint64_t));
+	}
+	else if(sim->currentBoard != NULL){
+		for(row = 0; row < cp->rows; row++){
+			cells = ROW(sim->currentBoard,row);
+			words = cp->bits + (size_t) row * cp->words;
+			for(col = 0; col < cp->cols; col += BITS_PER_WORD){
+				word = 0;
+				for(bit = 0; bit < BITS_PER_WORD && col + bit < cp->cols;
+					bit++){
+					word |= (uint64_t) (cells[col + bit] != 0) << bit;
+				}
+				words[col / BITS_PER_WORD] = word;
+			}
+		}
+	}
+	else{
+		for(row = 0; row < cp->rows; row++){
+			for(col = 0; col < cp->cols; col++){
+				if(getHashlifeCell(sim->hl,row,col)){
+					cp->bits[(size_t) row * cp->words + col / BITS_PER_WORD]
+						|= 1ULL << (col % BITS_PER_WORD);
+				}
+			}
+		}
+	}
+	return cp;
+}
+
+/**
+ * Loads the board of a checkpoint, continuing at its generation with its
+ * live counts. The tile counts start over.
+ * @param sim: the simulator
+ * @param cp: the checkpoint, may be freed once this returns
+ * @return: 0 on success, -1 if the checkpoint can not be used (see
+ *          simulatorError), the simulator then has no board
+ * @throws exit(1) if the boards can not be allocated
+ */
+int resumeSimulator(simulator* sim, const checkpoint* cp){
+	int* cells;
+	long long numCells = 0;
+	size_t word;
+	int row, col;
+	int result;
+
+	if(cp->wrap != sim->opts.wrap){
+		freeBoardState(sim);
+		sim->error = "checkpoint wrap does not match";
+		return -1;
+	}
+	if(sim->opts.engine == ENGINE_HASHLIFE){
+		for(word = 0; word < (size_t) cp->rows * cp->words; word++){
+			numCells += __builtin_popcountll(cp->bits[word]);
+		}
+		if(numCells > 0x3fffffff){
+			freeBoardState(sim);
+			sim->error = "too many live cells in checkpoint";
+			return -1;
+		}
+		cells = (int*) malloc(2 * sizeof(int) * (numCells + 1));
+		if(cells == NULL){
+			printf("%s", "error allocating cells");
+			exit(1);
+		}
+		numCells = 0;
+		for(row = 0; row < cp->rows; row++){
+			for(col = 0; col < cp->cols; col++){
+				if(getCheckpointCell(cp,row,col)){
+					cells[2*numCells] = row;
+					cells[2*numCells+1] = col;
+					numCells++;
+				}
+			}
+		}
+		result = loadSimulator(sim,cp->rows,cp->cols,cells,numCells);
+		free(cells);
+	}
+	else{
+		result = loadSimulator(sim,cp->rows,cp->cols,NULL,0);
+	}
+	if(result != 0){
+		return result;
+	}
+	if(sim->currentBits != NULL){
+		memcpy(sim->currentBits->bits, cp->bits,
+			(size_t) cp->rows * cp->words * sizeof(uint64_t));
+		for(row = 0; row < cp->rows; row++){
+			sim->currentBits->bits[(size_t) row * cp->words + cp->words - 1]
+				&= sim->currentBits->lastMask;
+		}
+	}
+	else if(sim->currentBoard != NULL){
+		for(row = 0; row < cp->rows; row++){
+			for(col = 0; col < cp->cols; col++){
+				CELL(sim->currentBoard,row,col) =
+					getCheckpointCell(cp,row,col);
+			}
+		}
+		if(sim->opts.wrap){
+			refreshHalo(sim->currentBoard);
+		}
+	}
+	sim->generation = cp->generation;
+	sim->liveCount = cp->liveCount;
+	sim->totalLiveCount = cp->totalLiveCount;
+	return 0;
+}
+
+/**
+ * Returns the generation of the simulator's board, 0 when loaded
+ * @param sim: the simulator
+ * @return: the generation
+ */
+int simulatorGeneration(const simulator* sim){
+	return sim->generation;
+}
+
+/**
+ * Returns the number of live cells in the current board
+ * @param sim: the simulator
+ * @return: the live count
+ */
+long long simulatorLiveCount(const simulator* sim){
+	return sim->liveCount;
+}
+
+/**
+ * Returns the live cells summed over every generation calculated since the
+ * board was loaded
+ * @param sim: the simulator
+ * @return: the total live count
+ */
+long long simulatorTotalLiveCount(const simulator* sim){
+	return sim->totalLiveCount;
+}
+
+/**
+ * Returns the period of the cycle the board settled into
+ * @param sim: the simulator
+ * @return: the generations between repeats of the board, 1 for a still
+ *          life, 0 if no cycle was found or detection is off
+ */
+int simulatorPeriod(const simulator* sim){
+	return sim->period;
+}
+
+/**
+ * Returns the generation the board's cycle was confirmed from, by comparing
+ * the board with the board a period later. The cycle started a period or
+ * more before it.
+ * @param sim: the simulator
+ * @return: the generation, 0 if no cycle was found
+ */
+int simulatorStableGeneration(const simulator* sim){
+	return sim->period > 0 ? sim->stableGeneration : 0;
+}
+
+/**
+ * Returns the tiles of the active region recalculated in the last step, or
+ * during the whole last call of stepSimulator when the threads were
+ * pipelined
+ * @param sim: the simulator
+ * @return: the tiles recalculated
+ */
+long long simulatorTilesProcessed(const simulator* sim){
+	return sim->tilesProcessed;
+}
+
+/**
+ * Returns the tiles of the active region recalculated since the board was
+ * loaded
+ * @param sim: the simulator
+ * @return: the tiles recalculated
+ */
+long long simulatorTotalTilesProcessed(const simulator* sim){
+	return sim->totalTilesProcessed;
+}
+
+/**
+ * Returns the number of tiles of the active region
+ * @param sim: the simulator
+ * @return: the number of tiles, 0 if there is no active region
+ */
+int simulatorTileCount(const simulator* sim){
+	if(sim->tiles == NULL){
+		return 0;
+	}
+	return sim->tiles->tileRows * sim->tiles->tileCols;
+}
+
+/**
+ * Returns the state of a cell of the current board
+ * @param sim: the simulator
+ * @param row: the row of the cell
+ * @param col: the column of the cell
+ * @return: 1 if the cell is alive, 0 if it is dead or outside of the board
+ */
+int getSimulatorCell(const simulator* sim, int row, int col){
+	if(!sim->loaded || row < 0 || row >= sim->rows || col < 0 ||
+		col >= sim->cols){
+		return 0;
+	}
+	if(sim->hl != NULL){
+		return getHashlifeCell(sim->hl,row,col);
+	}
+	if(sim->currentBits != NULL){
+		return getBitCell(sim->currentBits,row,col);
+	}
+	return CELL(sim->currentBoard,row,col) != 0;
+}
+
+/**
+ * Prints the current board with the display function matching the board
+ * type
+ * @param sim: the simulator
+ * @return nothing
+ */
+void displaySimulator(const simulator* sim){
+	if(sim->hl != NULL){
+		displayHashlife(sim->hl);
+	}
+	else if(sim->currentBits != NULL){
+		displayBitBoard(sim->currentBits);
+	}
+	else if(sim->currentBoard != NULL){
+		displayBoard(sim->currentBoard);
+	}
+}
+
+/**
+ * Prints the instruction set the simd kernel picked, the slice of each
+ * thread of the sweep, or with tile partitioning the tiles each one
+ * calculated and stole, then the CPU each thread is pinned to and for a
+ * profiled simulator where each thread's time went. Prints nothing for
+ * Hashlife.
+ * @param sim: the simulator
+ * @return nothing
+ */
+void printSimulatorThreads(const simulator* sim){
+	threadArg* arg;
+	int i;
+
+	if(sim->threadInput == NULL){
+		return;
+	}
+	if(sim->simdRow != NULL){
+		printf("Simd instruction set: %s\n\n",simdKernelName(sim->simdRow));
+	}
+	for(i = 0; i < sim->opts.numThreads; i++){
+		arg = &sim->threadInput[i];
+		if(arg->schedule != NULL){
+			printTileSchedule(arg->threadNum,arg->numThreads,arg->tilesDone,
+				arg->steals);
+		}
+		else{
+			printPartition(arg->threadNum,arg->numThreads,arg->begRow,
+				arg->endRow,arg->begCol,arg->endCol,arg->maxRow,arg->maxCol);
+		}
+	}
+	if(sim->cpus != NULL){
+		printf("\n");
+		for(i = 0; i < sim->opts.numThreads; i++){
+			printThreadCpu(i,sim->opts.numThreads,sim->cpus[i],
+				sim->nodes[i]);
+		}
+	}
+	if(sim->profiles == NULL){
+		return;
+	}
+	printf("\n");
+	for(i = 0; i < sim->opts.numThreads; i++){
+		printThreadProfile(i,sim->opts.numThreads,&sim->profiles[i]);
+	}
+}
+
+/**
+ * Writes the phases of every thread since the board was loaded as a Chrome
+ * trace (the trace event format read by chrome://tracing and Perfetto),
+ * one complete event per phase with the thread as its tid
+ * @param sim: the simulator, created with PROFILE_TRACE
+ * @param fileName: the name of the file
+ * @return: 0 on success, -1 if the simulator keeps no trace or the file
+ *          could not be written (see simulatorError)
+ */
+int writeSimulatorTrace(simulator* sim, const char* fileName){
+	static const char* names[] = {"compute", "barrier", "neighbors"};
+	threadProfile* profile;
+	traceEvent* event;
+	FILE* outFile;
+	int i, j;
+	int failed;
+
+	if(sim->opts.profile != PROFILE_TRACE){
+		sim->error = "simulator keeps no trace";
+		return -1;
+	}
+	outFile = fopen(fileName, "w");
+	if(outFile == NULL){
+		sim->error = "Error opening trace file.";
+		return -1;
+	}
+	fprintf(outFile, "{\"displayTimeUnit\": \"ms\", \"traceEvents\": [\n");
+	for(i = 0; i < sim->opts.numThreads; i++){
+		fprintf(outFile, "%s{\"name\": \"thread_name\", \"ph\": \"M\", "
+			"\"pid\": 1, \"tid\": %d, \"args\": {\"name\": "
+			"\"thread %d\"}}", i > 0 ? ",\n" : "", i, i);
+	}
+	for(i = 0; i < sim->opts.numThreads; i++){
+		profile = &sim->profiles[i];
+		for(j = 0; j < profile->numEvents; j++){
+			event = &profile->events[j];
+			fprintf(outFile, ",\n{\"name\": \"%s\", \"ph\": \"X\", "
+				"\"ts\": %0.3f, \"dur\": %0.3f, \"pid\": 1, \"tid\": %d, "
+				"\"args\": {\"generation\": %d}}",names[event->type],
+				(event->begin - sim->profileStart) / 1e3,
+				(event->end - event->begin) / 1e3,i,event->generation);
+		}
+	}
+	fprintf(outFile, "\n]}\n");
+	failed = ferror(outFile);
+	failed = fclose(outFile) != 0 || failed;
+	if(failed){
+		sim->error = "error writing trace";
+		return -1;
+	}
+	return 0;
+}
+
+/**
+ * Returns why the last call that failed on the simulator failed
+ * @param sim: the simulator
+ * @return: the error message
+ */
+const char* simulatorError(const simulator* sim){
+	return sim->error;
+}
@@ -0,0 +1,111 @@
+//simulator.h
+//Description: Reentrant Game of Life simulator. Everything a simulation
+//             needs, its boards, live counts, barrier and a pool of worker
+//             threads, is kept in a simulator object. The pool lives as long
+//             as the simulator, so many boards can be loaded and stepped one
+//             after the other without creating threads each time, and
+//             several simulators can run at once in one process. The thread
+//             calling stepSimulator works as thread 0 of the pool.
+//             A profiled simulator times how long each thread calculates
+//             and waits every step, for printSimulatorThreads and, with
+//             PROFILE_TRACE, a Chrome trace of every phase. With numa the
+//             threads are pinned node by node and clear the rows they
+//             calculate themselves, so those rows stay on their node.
+//             With cycle detection every generation is hashed, and once the
+//             hash repeats one of the last cycleHistory generations the
+//             sweep stops, compares the board with the board a period
+//             later and, if they are the same, extrapolates the rest of the
+//             run from the period.
+
+#ifndef SIMULATOR_H
+#define SIMULATOR_H
+
+#include "checkpoint.h"
+
+#define KERNEL_SCALAR 0 // byte grid, neighbors summed per cell
+#define KERNEL_BITPACK 1 // bit-packed grid, 64 cells per step
+#define KERNEL_SIMD 2 // byte grid, one vector of cells per step
+#define KERNEL_LUT 3 // byte grid, one table lookup per 2x2 block of cells
+#define KERNEL_ROLLING 4 // byte grid, rolling column sums, each cell read once
+
+#define ENGINE_SWEEP 0 // threads sweep their slice every generation
+#define ENGINE_HASHLIFE 1 // memoized quadtree, 2^k generations per step
+
+#define BARRIER_SPIN 0 // spinBarrier, spins then sleeps on a futex
+#define BARRIER_PTHREAD 1 // pthread_barrier_t
+
+#define PARTITION_ROW 0 // each thread gets a band of rows
+#define PARTITION_COL 1 // each thread gets a band of columns
+#define PARTITION_TILE 2 // tiles handed out each generation, work stealing
+
+#define PROFILE_OFF 0 // no timing, the step loop has none of its code
+#define PROFILE_SUMMARY 1 // time each thread's phases, printed per thread
+#define PROFILE_TRACE 2 // also keep every phase for writeSimulatorTrace
+
+#define CYCLE_HISTORY 64 // Generations searched for a repeat with --cycles
+
+typedef struct simOptions{
+	int numThreads; // Threads of the pool, including the calling thread
+	int partition; // One of the PARTITION_ values
+	int wrap; // 0 for nowrap 1 for wrap
+	int kernel; // Step kernel, one of the KERNEL_ values
+	int simdIsa; // Instruction set of the simd kernel, one of the SIMD_ values
+	int engine; // ENGINE_SWEEP or ENGINE_HASHLIFE
+	int tileSize; // Cells per tile side of the active region, 0 for none
+	int depth; // Generations calculated between barriers
+	int barrier; // BARRIER_SPIN or BARRIER_PTHREAD
+	int profile; // One of the PROFILE_ values
+	int numa; // 1 to pin the threads and have them clear their own rows
+	int cycleHistory; // Generations searched for a repeat, 0 for no detection
+} simOptions;
+
+typedef struct simulator simulator;
+
+void defaultSimOptions(simOptions* opts);
+
+const char* parseSimOption(simOptions* opts, const char* arg);
+
+const char* checkSimOptions(const simOptions* opts);
+
+simulator* createSimulator(const simOptions* opts);
+
+void destroySimulator(simulator* sim);
+
+int loadSimulator(simulator* sim, int row, int col, const int* cells,
+	int numCells);
+
+int stepSimulator(simulator* sim, int generations);
+
+checkpoint* snapshotSimulator(simulator* sim);
+
+int resumeSimulator(simulator* sim, const checkpoint* cp);
+
+int simulatorGeneration(const simulator* sim);
+
+long long simulatorLiveCount(const simulator* sim);
+
+long long simulatorTotalLiveCount(const simulator* sim);
+
+int simulatorPeriod(const simulator* sim);
+
+int simulatorStableGeneration(const simulator* sim);
+
+long long simulatorTilesProcessed(const simulator* sim);
+
+long long simulatorTotalTilesProcessed(const simulator* sim);
+
+int simulatorTileCount(const simulator* sim);
+
+int getSimulatorCell(const simulator* sim, int row, int col);
+
+void displaySimulator(const simulator* sim);
+
+void printSimulatorThreads(const simulator* sim);
+
+int writeSimulatorTrace(simulator* sim, const char* fileName);
+
+const char* simulatorError(const simulator* sim);
+
+void partitionBand(int numParts, int size, int part, int* beg, int* end);
+
+#endif /* SIMULATOR_H */
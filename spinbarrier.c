@@ -0,0 +1,153 @@
+//spinbarrier.c
+//Description: Spin then futex barrier. A thread reads the sense before it
+//             counts itself in; the phase can not end before it arrives, so
+//             that is the sense of its own phase. The last thread resets the
+//             count before flipping the sense, so threads released by the
+//             flip already count toward the next phase. The sense is also
+//             the futex word, a sleeper only goes to sleep if it still holds
+//             the value it read. Sleepers count themselves in before
+//             checking the sense, so the last thread only makes the wake
+//             system call when someone may be asleep.
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <sched.h>
+#include "spinbarrier.h"
+
+#ifdef __linux__
+#include <unistd.h>
+#include <limits.h>
+#include <sys/syscall.h>
+#include <linux/futex.h>
+#endif
+
+/**
+ * Tells the CPU the thread is spinning so it can save power and leave the
+ * core's resources to the other hyperthread
+ * @return nothing
+ */
+static void spinPause(){
+#if defined(__x86_64__) || defined(__i386__)
+	__builtin_ia32_pause();
+#elif defined(__aarch64__)
+	__asm__ __volatile__("yield");
+#endif
+}
+
+/**
+ * Sleeps until a word no longer holds the value given, or returns at once
+ * if it already changed
+ * @param word: the word, the sense of a barrier or a progress flag
+ * @param value: the value the thread is waiting to change
+ * @return nothing
+ */
+static void sleepOnWord(unsigned int* word, unsigned int value){
+#ifdef __linux__
+	syscall(SYS_futex, word, FUTEX_WAIT_PRIVATE, value, NULL, NULL, 0);
+#else
+	(void) word;
+	(void) value;
+	sched_yield();
+#endif
+}
+
+/**
+ * Wakes every thread sleeping on a word
+ * @param word: the word, the sense of a barrier or a progress flag
+ * @return nothing
+ */
+static void wakeAll(unsigned int* word){
+#ifdef __linux__
+	syscall(SYS_futex, word, FUTEX_WAKE_PRIVATE, INT_MAX, NULL, NULL, 0);
+#else
+	(void) word;
+#endif
+}
+
+/**
+ * Initializes a barrier for a number of threads
+ * @param barrier: the barrier
+ * @param count: the number of threads that must arrive, at least 1
+ * @param spins: the spin rounds before a waiting thread sleeps, 0 to sleep
+ *               at once (when there are more threads than cores)
+ * @return nothing
+ */
+void initializeSpinBarrier(spinBarrier* barrier, unsigned int count,
+	int spins){
+	barrier->limit = count;
+	barrier->count = 0;
+	barrier->sense = 0;
+	barrier->sleepers = 0;
+	barrier->spins = spins;
+}
+
+/**
+ * Waits until every thread arrived at the barrier
+ * @param barrier: the barrier
+ * @return: 1 for the last thread to arrive, 0 for the others, like
+ *          PTHREAD_BARRIER_SERIAL_THREAD
+ */
+int spinBarrierWait(spinBarrier* barrier){
+	unsigned int sense = __atomic_load_n(&barrier->sense, __ATOMIC_ACQUIRE);
+	int i;
+
+	if(__atomic_add_fetch(&barrier->count, 1, __ATOMIC_ACQ_REL) ==
+		barrier->limit){
+		__atomic_store_n(&barrier->count, 0, __ATOMIC_RELAXED);
+		__atomic_store_n(&barrier->sense, !sense, __ATOMIC_SEQ_CST);
+		if(__atomic_load_n(&barrier->sleepers, __ATOMIC_SEQ_CST) != 0){
+			wakeAll(&barrier->sense);
+		}
+		return 1;
+	}
+	for(i = 0; i < barrier->spins; i++){
+		if(__atomic_load_n(&barrier->sense, __ATOMIC_ACQUIRE) != sense){
+			return 0;
+		}
+		spinPause();
+	}
+	__atomic_add_fetch(&barrier->sleepers, 1, __ATOMIC_SEQ_CST);
+	while(__atomic_load_n(&barrier->sense, __ATOMIC_SEQ_CST) == sense){
+		sleepOnWord(&barrier->sense,sense);
+	}
+	__atomic_sub_fetch(&barrier->sleepers, 1, __ATOMIC_RELAXED);
+	return 0;
+}
+
+/**
+ * Publishes that the owner of a flag completed a number of steps and wakes
+ * the threads sleeping until it did
+ * @param flag: the owner's flag
+ * @param value: the number of steps completed, never less than before
+ * @return nothing
+ */
+void publishProgress(progressFlag* flag, unsigned int value){
+	__atomic_store_n(&flag->value, value, __ATOMIC_SEQ_CST);
+	if(__atomic_load_n(&flag->sleepers, __ATOMIC_SEQ_CST) != 0){
+		wakeAll(&flag->value);
+	}
+}
+
+/**
+ * Waits until the owner of a flag completed at least a number of steps
+ * @param flag: the owner's flag
+ * @param value: the number of steps to wait for
+ * @param spins: the spin rounds before sleeping
+ * @return nothing
+ */
+void waitProgress(progressFlag* flag, unsigned int value, int spins){
+	unsigned int seen;
+	int i;
+
+	for(i = 0; i < spins; i++){
+		if(__atomic_load_n(&flag->value, __ATOMIC_ACQUIRE) >= value){
+			return;
+		}
+		spinPause();
+	}
+	__atomic_add_fetch(&flag->sleepers, 1, __ATOMIC_SEQ_CST);
+	while((seen = __atomic_load_n(&flag->value, __ATOMIC_SEQ_CST)) < value){
+		sleepOnWord(&flag->value,seen);
+	}
+	__atomic_sub_fetch(&flag->sleepers, 1, __ATOMIC_RELAXED);
+}
@@ -0,0 +1,39 @@
+//spinbarrier.h
+//Description: Sense-reversing barrier for the generation loop. Waiting
+//             threads spin on the barrier's sense for a bounded number of
+//             rounds, which is much cheaper than sleeping when the other
+//             threads are only microseconds behind, and then sleep on a
+//             futex (sched_yield where there are no futexes) until the last
+//             thread flips the sense.
+//             Progress flags split a barrier into its two halves: a thread
+//             arrives by publishing how far it got and only waits for the
+//             threads whose results it needs, with the same spin then sleep.
+
+#ifndef SPINBARRIER_H
+#define SPINBARRIER_H
+
+#define SPIN_LIMIT 4000 // Spin rounds before a waiting thread sleeps
+
+typedef struct spinBarrier{
+	unsigned int limit; // Number of threads that must arrive
+	unsigned int count; // Threads that arrived in this phase
+	unsigned int sense; // Flipped by the last thread to end the phase
+	unsigned int sleepers; // Threads that stopped spinning, to be woken
+	int spins; // Spin rounds before sleeping
+} __attribute__((aligned(64))) spinBarrier;
+
+void initializeSpinBarrier(spinBarrier* barrier, unsigned int count,
+	int spins);
+
+int spinBarrierWait(spinBarrier* barrier);
+
+typedef struct progressFlag{
+	unsigned int value; // Steps the owner completed
+	unsigned int sleepers; // Threads that stopped spinning, to be woken
+} __attribute__((aligned(64))) progressFlag;
+
+void publishProgress(progressFlag* flag, unsigned int value);
+
+void waitProgress(progressFlag* flag, unsigned int value, int spins);
+
+#endif /* SPINBARRIER_H */
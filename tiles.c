@@ -0,0 +1,142 @@
+//tiles.c
+//Description: Tile map of the active region. Tile [r,c] covers rows
+//             r*tileSize to r*tileSize+tileSize-1 and the same range of
+//             columns, clipped to the grid. A tile marked as changed in
+//             generation g differs from generation g-1, so it and its
+//             neighbors are recalculated when generation g+1 is computed.
+//             The marks of even and odd generations are kept apart, so a
+//             thread marking a tile for g+1 never hides the mark for g from
+//             a thread still reading it. Two threads whose slices share a
+//             tile may both mark it, so the marks are atomic stores.
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include "tiles.h"
+
+/**
+ * Dynamically allocates the tile map of a board of size row x col with
+ * every tile marked as changed in generation 0, since the next board does
+ * not hold the previous generation yet
+ * @param row: the number of rows in the grid
+ * @param col: the number of columns in the grid
+ * @param tileSize: the rows and columns of cells per tile
+ * @param wrap: 0 for nowrap 1 for wrap
+ * @return: returns a pointer to the newly initialized tile map
+ * @throws exit(1) if the map can not be allocated
+ */
+tileMap* initializeTileMap(int row, int col, int tileSize, int wrap){
+	tileMap* tiles;
+
+	tiles = (tileMap*) malloc(sizeof(tileMap));
+	if(tiles == NULL){
+		printf("%s", "error allocating tile map");
+		exit(1);
+	}
+	tiles->tileSize = tileSize;
+	tiles->tileRows = (row + tileSize - 1) / tileSize;
+	tiles->tileCols = (col + tileSize - 1) / tileSize;
+	tiles->wrap = wrap;
+	tiles->changed = (int*) calloc(2 * (size_t) tiles->tileRows *
+		tiles->tileCols, sizeof(int));
+	tiles->live = (int*) calloc((size_t) tiles->tileRows * tiles->tileCols,
+		sizeof(int));
+	if(tiles->changed == NULL || tiles->live == NULL){
+		printf("%s", "error allocating tile map");
+		exit(1);
+	}
+	return tiles;
+}
+
+/**
+ * Frees the memory allocated for a tile map
+ * @param tiles: the tile map to free, may be NULL
+ * @return nothing
+ */
+void freeTileMap(tileMap* tiles){
+	if(tiles != NULL){
+		free(tiles->changed);
+		free(tiles->live);
+		free(tiles);
+	}
+}
+
+/**
+ * Checks if a tile has to be recalculated to compute the generation after
+ * generation, which is the case when the tile or one of its neighbors
+ * changed in generation
+ * @param tiles: the tile map
+ * @param tileRow: row of the tile
+ * @param tileCol: column of the tile
+ * @param generation: the generation held by the current board
+ * @return: 1 if the tile is active, 0 if it stays the same
+ */
+int tileActive(const tileMap* tiles, int tileRow, int tileCol,
+	int generation){
+	const int* marks = tiles->changed + (size_t) (generation & 1) *
+		tiles->tileRows * tiles->tileCols;
+	int i;
+	int j;
+	int r;
+	int c;
+
+	for(i = tileRow-1; i <= tileRow+1; i++){
+		for(j = tileCol-1; j <= tileCol+1; j++){
+			r = i;
+			c = j;
+			if(tiles->wrap){
+				r = (r + tiles->tileRows) % tiles->tileRows;
+				c = (c + tiles->tileCols) % tiles->tileCols;
+			}
+			else if(r < 0 || r >= tiles->tileRows || c < 0 ||
+				c >= tiles->tileCols){
+				continue;
+			}
+			if(__atomic_load_n(&marks[r*tiles->tileCols+c],
+				__ATOMIC_RELAXED) == generation){
+				return 1;
+			}
+		}
+	}
+	return 0;
+}
+
+/**
+ * Marks a tile as changed in a generation
+ * @param tiles: the tile map
+ * @param tileRow: row of the tile
+ * @param tileCol: column of the tile
+ * @param generation: the generation the tile changed in
+ * @return nothing
+ */
+void markTileChanged(tileMap* tiles, int tileRow, int tileCol,
+	int generation){
+	int* marks = tiles->changed + (size_t) (generation & 1) *
+		tiles->tileRows * tiles->tileCols;
+
+	__atomic_store_n(&marks[tileRow*tiles->tileCols+tileCol],
+		generation, __ATOMIC_RELAXED);
+}
+
+/**
+ * Checks if a region of the next board differs from the current board
+ * @param currentBoard: pointer to the grid for the current iteration
+ * @param nextBoard: pointer to the grid for the next iteration
+ * @param begRow: The start row of the region
+ * @param begCol: The start col of the region
+ * @param endCol: One past the end col of the region
+ * @param endRow: One past the end row of the region
+ * @return: 1 if any cell of the region changed, 0 otherwise
+ */
+int regionChanged(const cellBoard* currentBoard, const cellBoard* nextBoard,
+	int begRow, int begCol, int endCol, int endRow){
+	int i;
+
+	for(i = begRow; i < endRow; i++){
+		if(memcmp(ROW(currentBoard,i) + begCol, ROW(nextBoard,i) + begCol,
+			(endCol - begCol) * sizeof(cell)) != 0){
+			return 1;
+		}
+	}
+	return 0;
+}
@@ -0,0 +1,38 @@
+//tiles.h
+//Description: Active region tracking for the byte grid. The board is divided
+//             into square tiles and the generation each tile last changed in
+//             is kept, so a tile is only recalculated when it or one of its
+//             eight neighbors changed in the previous generation. A tile that
+//             is skipped already holds the right cells in the next board,
+//             because it was the same two generations ago.
+
+#ifndef TILES_H
+#define TILES_H
+
+#include "board.h"
+
+#define TILE_SIZE 32 // Default rows and columns of cells per tile
+
+typedef struct tileMap{
+	int tileSize; // Rows and columns of cells per tile
+	int tileRows; // Number of rows of tiles
+	int tileCols; // Number of columns of tiles
+	int wrap; // 0 for nowrap 1 for wrap, tiles on the edges are neighbors
+	int* changed; // Generation each tile last changed in, even then odd ones
+	int* live; // Live cells of each tile, kept by the tile partition
+} tileMap;
+
+tileMap* initializeTileMap(int row, int col, int tileSize, int wrap);
+
+void freeTileMap(tileMap* tiles);
+
+int tileActive(const tileMap* tiles, int tileRow, int tileCol,
+	int generation);
+
+void markTileChanged(tileMap* tiles, int tileRow, int tileCol,
+	int generation);
+
+int regionChanged(const cellBoard* currentBoard, const cellBoard* nextBoard,
+	int begRow, int begCol, int endCol, int endRow);
+
+#endif /* TILES_H */
@@ -0,0 +1,148 @@
+//tiletest.c
+//Description: Checks the tiles processed count of the active region. Random
+//             boards are stepped one generation at a time with 1 to
+//             MAX_THREADS threads and every partition, and each generation
+//             the tiles recalculated must not pass the tiles of the board
+//             and must be the same as with one thread, so a tile split
+//             between slices is only counted once.
+//             Usage: ./tiletest
+//             Prints each failing run and exits 1 if there is one.
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <stdint.h>
+#include "simulator.h"
+
+#define MAX_THREADS 8 // Most threads of a run
+#define GENERATIONS 30 // Generations stepped per run
+
+typedef struct testBoard{
+	int rows; // Number of rows
+	int cols; // Number of columns
+	int tileSize; // Cells per tile side
+} testBoard;
+
+static const testBoard boards[] = {
+	{10, 10, 8}, {200, 200, 32}, {130, 70, 16}, {65, 300, 7}, {1, 90, 8}
+};
+
+/**
+ * Makes the live cells of a random board, about a third of its cells
+ * @param rows: the number of rows
+ * @param cols: the number of columns
+ * @param numCells: gets the number of live cells
+ * @return: the row, column pairs of the live cells
+ * @throws exit(1) if the cells can not be allocated
+ */
+static int* randomCells(int rows, int cols, int* numCells){
+	uint32_t state = (uint32_t) rows * 2654435761u ^ (uint32_t) cols;
+	int* cells;
+	int row, col;
+
+	cells = (int*) malloc(2 * sizeof(int) * ((size_t) rows * cols + 1));
+	if(cells == NULL){
+		printf("%s", "error allocating cells");
+		exit(1);
+	}
+	*numCells = 0;
+	for(row = 0; row < rows; row++){
+		for(col = 0; col < cols; col++){
+			state = state * 1664525u + 1013904223u;
+			if(state >> 30 == 0){
+				cells[2 * *numCells] = row;
+				cells[2 * *numCells + 1] = col;
+				(*numCells)++;
+			}
+		}
+	}
+	return cells;
+}
+
+/**
+ * Steps a board one generation at a time and records the tiles processed
+ * each generation
+ * @param board: the board
+ * @param cells: its live cells
+ * @param numCells: the number of live cells
+ * @param opts: the simulator options
+ * @param processed: gets the tiles processed of each generation
+ * @return: the number of tiles of the board
+ * @throws exit(1) if the simulator can not be created or loaded
+ */
+static int runBoard(const testBoard* board, const int* cells, int numCells,
+	const simOptions* opts, long long* processed){
+	simulator* sim;
+	int tiles;
+	int i;
+
+	sim = createSimulator(opts);
+	if(sim == NULL || loadSimulator(sim,board->rows,board->cols,cells,
+		numCells) != 0){
+		printf("%s", "error loading the board");
+		exit(1);
+	}
+	for(i = 0; i < GENERATIONS; i++){
+		stepSimulator(sim,1);
+		processed[i] = simulatorTilesProcessed(sim);
+	}
+	tiles = simulatorTileCount(sim);
+	destroySimulator(sim);
+	return tiles;
+}
+
+/**
+ * Main. Runs every board with every thread count, partition and wrap.
+ * @return: 0 if every run passed, exits 1 otherwise
+ */
+int main(){
+	static const char* partitions[] = {"row", "col", "tile"};
+	long long expected[GENERATIONS];
+	long long processed[GENERATIONS];
+	simOptions opts;
+	const testBoard* board;
+	int* cells;
+	int numCells;
+	int tiles;
+	int b, threads, part, wrap, i;
+	int failures = 0;
+
+	for(b = 0; b < (int) (sizeof(boards) / sizeof(boards[0])); b++){
+		board = &boards[b];
+		cells = randomCells(board->rows,board->cols,&numCells);
+		for(wrap = 0; wrap <= 1; wrap++){
+			defaultSimOptions(&opts);
+			opts.wrap = wrap;
+			opts.tileSize = board->tileSize;
+			opts.numThreads = 1;
+			runBoard(board,cells,numCells,&opts,expected);
+			for(threads = 1; threads <= MAX_THREADS; threads++){
+				for(part = 0; part < 3; part++){
+					opts.numThreads = threads;
+					opts.partition = part == 0 ? PARTITION_ROW :
+						part == 1 ? PARTITION_COL : PARTITION_TILE;
+					tiles = runBoard(board,cells,numCells,&opts,processed);
+					for(i = 0; i < GENERATIONS; i++){
+						if(processed[i] > tiles ||
+							processed[i] != expected[i]){
+							printf("FAIL %dx%d tile %d %d threads %s %s "
+								"generation %d: %lld of %d tiles, %lld "
+								"with 1 thread\n",board->rows,board->cols,
+								board->tileSize,threads,partitions[part],
+								wrap ? "wrap" : "nowrap",i + 1,processed[i],
+								tiles,expected[i]);
+							failures++;
+							break;
+						}
+					}
+				}
+			}
+		}
+		free(cells);
+	}
+	if(failures > 0){
+		printf("%d runs failed\n",failures);
+		exit(1);
+	}
+	printf("%s\n","All runs passed");
+	return 0;
+}
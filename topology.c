@@ -0,0 +1,263 @@
+//topology.c
+//Description: CPUs and NUMA nodes of the machine. Reads the cpulist of each
+//             /sys/devices/system/node/nodeN directory and the thread
+//             siblings of each CPU, and pins threads with the affinity
+//             calls of glibc.
+
+#define _GNU_SOURCE
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <dirent.h>
+#include <sched.h>
+#include <pthread.h>
+#include "topology.h"
+
+#define NODE_DIR "/sys/devices/system/node" // Directory of the nodes
+#define CPU_DIR "/sys/devices/system/cpu" // Directory of the CPUs
+#define LIST_LENGTH 4096 // Longest CPU list read
+
+/**
+ * Reads a CPU list file, numbers and ranges split by commas like 0-3,8-11
+ * @param fileName: the name of the file
+ * @param set: gets the CPUs of the list
+ * @return: 0 on success, -1 if the file could not be read
+ */
+static int readCpuList(const char* fileName, cpu_set_t* set){
+	FILE* inFile;
+	char list[LIST_LENGTH];
+	char* pos;
+	char* end;
+	long first, last, cpu;
+
+	CPU_ZERO(set);
+	inFile = fopen(fileName, "r");
+	if(inFile == NULL){
+		return -1;
+	}
+	if(fgets(list, sizeof(list), inFile) == NULL){
+		fclose(inFile);
+		return -1;
+	}
+	fclose(inFile);
+	pos = list;
+	while(*pos >= '0' && *pos <= '9'){
+		first = strtol(pos, &end, 10);
+		last = first;
+		if(*end == '-'){
+			last = strtol(end + 1, &end, 10);
+		}
+		for(cpu = first; cpu <= last && cpu < CPU_SETSIZE; cpu++){
+			CPU_SET(cpu, set);
+		}
+		pos = *end == ',' ? end + 1 : end;
+	}
+	return 0;
+}
+
+/**
+ * Checks if a CPU is the first hardware thread of its core
+ * @param cpu: the CPU
+ * @return: 1 if it is, or if its siblings can not be read, 0 otherwise
+ */
+static int firstOfCore(int cpu){
+	char fileName[128];
+	cpu_set_t siblings;
+	int i;
+
+	sprintf(fileName, "%s/cpu%d/topology/thread_siblings_list", CPU_DIR, cpu);
+	if(readCpuList(fileName,&siblings) != 0){
+		return 1;
+	}
+	for(i = 0; i < cpu; i++){
+		if(CPU_ISSET(i, &siblings)){
+			return 0;
+		}
+	}
+	return 1;
+}
+
+/**
+ * Adds the CPUs of a node that the process may run on and that no node
+ * added before holds, the first threads of cores first
+ * @param topo: the topology, gets the node
+ * @param nodeCpus: the CPUs of the node
+ * @param allowed: the CPUs the process may run on
+ * @param placed: the CPUs added so far, gets the node's
+ * @param node: the number of the node
+ * @return nothing
+ */
+static void addNode(cpuTopology* topo, cpu_set_t* nodeCpus,
+	cpu_set_t* allowed, cpu_set_t* placed, int node){
+	int pass, cpu;
+	int start = topo->numCpus;
+
+	for(pass = 0; pass < 2; pass++){
+		for(cpu = 0; cpu < CPU_SETSIZE; cpu++){
+			if(!CPU_ISSET(cpu, nodeCpus) || !CPU_ISSET(cpu, allowed) ||
+				CPU_ISSET(cpu, placed) || firstOfCore(cpu) != (pass == 0)){
+				continue;
+			}
+			CPU_SET(cpu, placed);
+			topo->cpus[topo->numCpus] = cpu;
+			topo->nodes[topo->numCpus] = node;
+			topo->numCpus++;
+		}
+	}
+	if(topo->numCpus > start){
+		topo->nodeStart[topo->numNodes++] = start;
+		topo->nodeStart[topo->numNodes] = topo->numCpus;
+	}
+}
+
+/**
+ * Compares two ints for qsort
+ * @param a: pointer to the first int
+ * @param b: pointer to the second int
+ * @return: negative, 0 or positive as a is less, equal or greater
+ */
+static int compareInts(const void* a, const void* b){
+	return (*(const int*) a > *(const int*) b) -
+		(*(const int*) a < *(const int*) b);
+}
+
+/**
+ * Reads the CPUs the process may run on and their nodes
+ * @return: the topology, with at least one CPU
+ * @throws exit(1) if the topology can not be allocated
+ */
+cpuTopology* readCpuTopology(void){
+	cpuTopology* topo;
+	cpu_set_t allowed, placed, nodeCpus;
+	char fileName[128];
+	DIR* dir;
+	struct dirent* entry;
+	int nodeNums[CPU_SETSIZE];
+	int numNodeNums = 0;
+	int count, i;
+
+	if(sched_getaffinity(0, sizeof(allowed), &allowed) != 0 ||
+		CPU_COUNT(&allowed) == 0){
+		CPU_ZERO(&allowed);
+		count = (int) sysconf(_SC_NPROCESSORS_ONLN);
+		for(i = 0; i < count && i < CPU_SETSIZE; i++){
+			CPU_SET(i, &allowed);
+		}
+	}
+	count = CPU_COUNT(&allowed) > 0 ? CPU_COUNT(&allowed) : 1;
+	topo = (cpuTopology*) malloc(sizeof(cpuTopology));
+	if(topo == NULL){
+		printf("%s", "error allocating topology");
+		exit(1);
+	}
+	topo->numCpus = 0;
+	topo->numNodes = 0;
+	topo->cpus = (int*) malloc(count * sizeof(int));
+	topo->nodes = (int*) malloc(count * sizeof(int));
+	topo->nodeStart = (int*) malloc((count + 1) * sizeof(int));
+	if(topo->cpus == NULL || topo->nodes == NULL || topo->nodeStart == NULL){
+		printf("%s", "error allocating topology");
+		exit(1);
+	}
+	topo->nodeStart[0] = 0;
+	CPU_ZERO(&placed);
+	dir = opendir(NODE_DIR);
+	if(dir != NULL){
+		while((entry = readdir(dir)) != NULL && numNodeNums < CPU_SETSIZE){
+			if(strncmp(entry->d_name, "node", 4) == 0 &&
+				entry->d_name[4] >= '0' && entry->d_name[4] <= '9'){
+				nodeNums[numNodeNums++] = atoi(entry->d_name + 4);
+			}
+		}
+		closedir(dir);
+	}
+	qsort(nodeNums, numNodeNums, sizeof(int), compareInts);
+	for(i = 0; i < numNodeNums; i++){
+		sprintf(fileName, "%s/node%d/cpulist", NODE_DIR, nodeNums[i]);
+		if(readCpuList(fileName,&nodeCpus) == 0){
+			addNode(topo,&nodeCpus,&allowed,&placed,nodeNums[i]);
+		}
+	}
+	if(topo->numCpus == 0){
+		//no node information, one node holds every CPU
+		addNode(topo,&allowed,&allowed,&placed,0);
+	}
+	if(topo->numCpus == 0){
+		topo->cpus[0] = 0;
+		topo->nodes[0] = 0;
+		topo->numCpus = 1;
+		topo->numNodes = 1;
+		topo->nodeStart[1] = 1;
+	}
+	return topo;
+}
+
+/**
+ * Frees a topology
+ * @param topo: the topology, may be NULL
+ * @return nothing
+ */
+void freeCpuTopology(cpuTopology* topo){
+	if(topo != NULL){
+		free(topo->cpus);
+		free(topo->nodes);
+		free(topo->nodeStart);
+		free(topo);
+	}
+}
+
+/**
+ * Picks the CPU of a thread of a pool. The threads are split between the
+ * nodes in proportion to their CPUs, in order and rounded so thread 0 is on
+ * the first node, and take the CPUs of their node in order, starting over
+ * when there are more threads than CPUs.
+ * @param topo: the topology
+ * @param threadNum: the number of the thread
+ * @param numThreads: the number of threads of the pool
+ * @return: the index of the thread's CPU in topo->cpus
+ */
+int threadCpu(const cpuTopology* topo, int threadNum, int numThreads){
+	int node;
+	long long first, last;
+
+	for(node = 0; node < topo->numNodes; node++){
+		first = ((long long) numThreads * topo->nodeStart[node] +
+			topo->numCpus - 1) / topo->numCpus;
+		last = ((long long) numThreads * topo->nodeStart[node + 1] +
+			topo->numCpus - 1) / topo->numCpus;
+		if(threadNum < last){
+			return topo->nodeStart[node] + (int) ((threadNum - first) %
+				(topo->nodeStart[node + 1] - topo->nodeStart[node]));
+		}
+	}
+	return threadNum % topo->numCpus;
+}
+
+/**
+ * Sets the attributes of a thread to be created so it only runs on one CPU
+ * @param attr: the attributes
+ * @param cpu: the CPU
+ * @return: 0 on success, -1 if the affinity can not be set
+ */
+int setAttrCpu(pthread_attr_t* attr, int cpu){
+	cpu_set_t set;
+
+	CPU_ZERO(&set);
+	CPU_SET(cpu, &set);
+	return pthread_attr_setaffinity_np(attr, sizeof(set), &set) == 0 ? 0 : -1;
+}
+
+/**
+ * Makes the calling thread only run on one CPU
+ * @param cpu: the CPU
+ * @return: 0 on success, -1 if the affinity can not be set
+ */
+int pinCallingThread(int cpu){
+	cpu_set_t set;
+
+	CPU_ZERO(&set);
+	CPU_SET(cpu, &set);
+	return pthread_setaffinity_np(pthread_self(), sizeof(set), &set) == 0 ?
+		0 : -1;
+}
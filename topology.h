@@ -0,0 +1,34 @@
+//topology.h
+//Description: CPUs and NUMA nodes of the machine, for pinning the threads
+//             of a pool. The nodes and their CPUs are read from
+//             /sys/devices/system/node (one node holding every CPU where it
+//             is missing), keeping only the CPUs the process may run on.
+//             Threads are placed node by node in proportion to each node's
+//             CPUs, so threads with neighboring numbers, which calculate
+//             neighboring bands, share a node, and within a node on distinct
+//             cores before the second hardware thread of any core.
+
+#ifndef TOPOLOGY_H
+#define TOPOLOGY_H
+
+#include <pthread.h>
+
+typedef struct cpuTopology{
+	int numCpus; // CPUs the process may run on
+	int numNodes; // Nodes holding at least one of them
+	int* cpus; // The CPUs, node by node, first threads of cores first
+	int* nodes; // Node of each CPU of cpus
+	int* nodeStart; // Index in cpus of each node's first CPU, numNodes+1
+} cpuTopology;
+
+cpuTopology* readCpuTopology(void);
+
+void freeCpuTopology(cpuTopology* topo);
+
+int threadCpu(const cpuTopology* topo, int threadNum, int numThreads);
+
+int setAttrCpu(pthread_attr_t* attr, int cpu);
+
+int pinCallingThread(int cpu);
+
+#endif /* TOPOLOGY_H */